@@ -0,0 +1,100 @@
+#pragma once
+
+#include "PieceFactory.hpp"
+#include "GraphicsFactory.hpp"
+#include "Moves.hpp"
+#include "Board.hpp"
+#include "img/ImgFactory.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// AssetBundle – one versioned file holding everything create_game reads from
+// the pieces/ tree: board.csv placements, every transitions.csv, config.json
+// and moves.txt already parsed, and all sprites pre-resized to the cell size
+// as raw pixels. Loading maps the file and views the pixels in place, so a
+// game starts with no PNG decoding, no JSON parsing and a single file open.
+//
+// Layout (host byte order; bundles are not portable across endianness):
+//   header  "KFCB", uint32 version, uint64 meta_size, uint64 pixels_offset
+//   meta    cell size, board size, board image, placements, piece types
+//   pixels  raw frames, each 64-byte aligned, referenced by offset
+// ---------------------------------------------------------------------------
+class AssetBundle {
+public:
+    static constexpr uint32_t kVersion = 1;
+
+    struct Frame {
+        int w{0};
+        int h{0};
+        int channels{0};
+        uint64_t offset{0};     // into the pixel section
+    };
+
+    // Scalar entry of a config.json section ("physics" / "graphics")
+    struct Param {
+        std::string key;
+        double value{0};
+        bool is_bool{false};
+    };
+
+    struct StateRecord {
+        std::string name;
+        std::vector<Param> physics_cfg;
+        std::vector<Param> graphics_cfg;
+        bool has_moves{false};
+        std::vector<Moves::RelMove> moves;
+        std::vector<Frame> frames;
+    };
+
+    struct Transition {
+        std::string from;
+        std::string event;
+        std::string to;
+    };
+
+    struct TypeRecord {
+        std::string type;
+        std::vector<StateRecord> states;   // sorted by name, as PieceFactory does
+        std::vector<Transition> transitions;
+    };
+
+    // Offline packer: walk pieces_root and write a bundle whose sprites are
+    // resized to cell_size (pixels) for a board of board_cells (W, H).
+    static void pack(const std::string& pieces_root,
+                     const std::string& out_path,
+                     const ImgFactoryPtr& img_factory,
+                     std::pair<int,int> cell_size,
+                     std::pair<int,int> board_cells);
+
+    // True if bundle_path exists and is at least as new as every file under
+    // pieces_root, i.e. kfc_pack has been re-run since the assets last changed.
+    static bool is_up_to_date(const std::string& bundle_path, const std::string& pieces_root);
+
+    // Map a bundle. Throws std::runtime_error if the file is missing, is not
+    // a bundle, or was written by another format version.
+    static std::shared_ptr<const AssetBundle> open(const std::string& path);
+
+    // Image viewing a frame's pixels inside the mapping (no copy).
+    ImgPtr image(const Frame& frame, const ImgFactoryPtr& img_factory) const;
+
+    // Build one PieceTemplate per bundled type and hand them to the factory.
+    void register_templates(PieceFactory& piece_factory,
+                            const Board& board,
+                            const GraphicsFactory& gfx_factory,
+                            const ImgFactoryPtr& img_factory) const;
+
+    std::pair<int,int> cell_size{0,0};      // (W, H) pixels
+    std::pair<int,int> board_cells{0,0};    // (W, H) cells
+    Frame board_image;
+    std::vector<PieceFactory::Placement> placements;
+    std::vector<TypeRecord> types;
+
+private:
+    struct Mapping;
+    std::shared_ptr<Mapping> mapping;
+    const uint8_t* pixels{nullptr};
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PieceFactory.hpp"
+#include "img/ImgFactory.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every sprite file a board needs, grouped by sprites folder.
+struct AssetManifest {
+    std::vector<PieceFactory::Placement> placements;
+    std::vector<std::pair<std::string, std::vector<std::string>>> sprite_folders;  // folder, frames
+
+    size_t file_count() const;
+};
+
+struct LoadTimings {
+    double scan_ms{0};
+    double decode_ms{0};
+    double wire_ms{0};
+    unsigned threads{0};
+    size_t files{0};
+};
+
+// ---------------------------------------------------------------------------
+// AssetLoader – three-phase startup used by create_game:
+//   scan   – read board.csv and list every sprite file of the piece types on it
+//   decode – decode/resize all files into SpriteCache on a pool of workers,
+//            then pack them into one SpriteAtlas
+//   wire   – build the state machines; Graphics then only hits the cache
+// ---------------------------------------------------------------------------
+class AssetLoader {
+public:
+    // threads == 0 uses std::thread::hardware_concurrency()
+    AssetLoader(ImgFactoryPtr img_factory, std::pair<int,int> cell_size, unsigned threads = 0);
+
+    std::vector<PiecePtr> load_pieces(PieceFactory& piece_factory, const std::string& board_csv_path);
+
+    AssetManifest scan(const std::string& pieces_root, const std::string& board_csv_path);
+    void decode(const AssetManifest& manifest);
+
+    // With lazy sprites the decode phase is skipped; Graphics decode on first draw.
+    void set_decode_upfront(bool enabled) { decode_upfront = enabled; }
+    // Pack the decoded sprites into one SpriteAtlas before wiring (default on).
+    void set_build_atlas(bool enabled) { build_atlas = enabled; }
+
+    const LoadTimings& timings() const { return timings_; }
+    void report() const;
+
+private:
+    ImgFactoryPtr img_factory;
+    std::pair<int,int> cell_size;
+    unsigned threads;
+    bool decode_upfront{true};
+    bool build_atlas{true};
+    LoadTimings timings_;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// Clock – source of game time (milliseconds since the clock started) and the
+// only way the game loop waits. Game uses a SteadyClock unless another one is
+// injected with Game::set_clock.
+// ---------------------------------------------------------------------------
+class Clock {
+public:
+    virtual ~Clock() = default;
+
+    virtual int now_ms() const = 0;
+    // Block (or pretend to) until now_ms() >= deadline_ms
+    virtual void sleep_until(int deadline_ms) = 0;
+};
+
+typedef std::shared_ptr<Clock> ClockPtr;
+
+// Wall-clock time from std::chrono::steady_clock
+class SteadyClock : public Clock {
+public:
+    SteadyClock() : start_tp(std::chrono::steady_clock::now()) {}
+
+    int now_ms() const override {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_tp).count());
+    }
+
+    void sleep_until(int deadline_ms) override {
+        int wait = deadline_ms - now_ms();
+        if(wait > 0) std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_tp;
+};
+
+// Simulated time: only moves when the loop sleeps (or advance() is called),
+// so a game runs as fast as the CPU allows and every run is reproducible.
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(int start_ms = 0) : t(start_ms) {}
+
+    int now_ms() const override { return t.load(std::memory_order_acquire); }
+
+    void sleep_until(int deadline_ms) override {
+        int cur = t.load(std::memory_order_relaxed);
+        while(cur < deadline_ms && !t.compare_exchange_weak(cur, deadline_ms, std::memory_order_acq_rel)) {}
+    }
+
+    void advance(int ms) { t.fetch_add(std::max(ms, 0), std::memory_order_acq_rel); }
+
+private:
+    std::atomic<int> t;
+};
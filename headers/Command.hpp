@@ -1,18 +1,39 @@
 #pragma once
 
+#include "Event.hpp"
+#include "SlotMap.hpp"
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <ostream>
 
+// Handle of a live piece in Game::pieces
+using PieceHandle = SlotHandle;
+
 struct Command {
     int timestamp;                 // ms since game start
     std::string piece_id;          // identifier of the piece (may be empty)
     std::string type;              // e.g., "move", "jump", "done"...
     std::vector<std::pair<int,int>> params;  // payload – board cells etc.
     int player_id = 1;             // player identifier (1 or 2)
+    PieceHandle piece;             // target piece; when set, used instead of piece_id
+    EventId event = Events::kNone; // type as a state-machine event id
 
+    Command() : timestamp(0) {}
     Command(int ts, std::string pid, std::string t, std::vector<std::pair<int,int>> p, int player = 1)
-        : timestamp(ts), piece_id(pid), type(t), params(p), player_id(player) {}
+        : timestamp(ts), piece_id(pid), type(t), params(p), player_id(player), event(Events::find(type)) {}
+
+    // Command for an event id, no string lookup
+    static Command from_event(int ts, EventId ev, std::vector<std::pair<int,int>> p = {}) {
+        Command cmd;
+        cmd.timestamp = ts;
+        cmd.type = Events::name(ev);
+        cmd.params = std::move(p);
+        cmd.event = ev;
+        return cmd;
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Command& cmd) {
         os << "Command(timestamp=" << cmd.timestamp;
@@ -27,4 +48,73 @@ struct Command {
         os << ")";
         return os;
     }
-};
\ No newline at end of file
+};
+
+// ---------------------------------------------------------------------------
+// CompactCommand – fixed-size, trivially copyable encoding of a Command, used
+// on the input queue and inside the simulation: the type as an event id, the
+// target piece as a handle and up to two cells inline. Building, queueing and
+// copying one never allocates. Converts to and from Command at the API edge.
+// ---------------------------------------------------------------------------
+struct CompactCommand {
+    static constexpr int kMaxCells = 2;
+
+    int32_t timestamp{0};
+    PieceHandle piece;                 // invalid: not addressed to a piece
+    EventId event{Events::kNone};
+    int8_t player_id{1};
+    uint8_t cell_count{0};
+    int16_t cells[kMaxCells][2]{};     // (row, col)
+
+    static CompactCommand make(int ts, EventId ev, int player = 1, PieceHandle piece = PieceHandle()) {
+        CompactCommand c;
+        c.timestamp = ts;
+        c.event = ev;
+        c.player_id = static_cast<int8_t>(player);
+        c.piece = piece;
+        return c;
+    }
+
+    // Ignored once kMaxCells cells are held
+    CompactCommand& add_cell(const std::pair<int,int>& cell) {
+        if(cell_count < kMaxCells) {
+            cells[cell_count][0] = static_cast<int16_t>(cell.first);
+            cells[cell_count][1] = static_cast<int16_t>(cell.second);
+            ++cell_count;
+        }
+        return *this;
+    }
+
+    std::pair<int,int> cell(int i) const { return {cells[i][0], cells[i][1]}; }
+
+    // True if cmd converts without loss: at most kMaxCells cells, each
+    // coordinate within int16 and the player within int8. from() truncates
+    // anything else, so check this first for input from outside.
+    static bool fits(const Command& cmd) {
+        auto in16 = [](int v) { return v >= std::numeric_limits<int16_t>::min() && v <= std::numeric_limits<int16_t>::max(); };
+        if(cmd.params.size() > static_cast<size_t>(kMaxCells)) return false;
+        if(cmd.player_id < std::numeric_limits<int8_t>::min() || cmd.player_id > std::numeric_limits<int8_t>::max()) return false;
+        for(const auto& p : cmd.params) {
+            if(!in16(p.first) || !in16(p.second)) return false;
+        }
+        return true;
+    }
+
+    // piece_id is not resolved here (only Game knows the handles), so the
+    // caller passes the piece; cells past the second are dropped.
+    static CompactCommand from(const Command& cmd, PieceHandle piece = PieceHandle()) {
+        CompactCommand c = make(cmd.timestamp, cmd.event, cmd.player_id, piece.valid() ? piece : cmd.piece);
+        for(const auto& p : cmd.params) c.add_cell(p);
+        return c;
+    }
+
+    Command to_command(const std::string& piece_id = "") const {
+        Command cmd = Command::from_event(timestamp, event);
+        cmd.piece_id = piece_id;
+        cmd.player_id = player_id;
+        cmd.piece = piece;
+        for(int i = 0; i < cell_count; ++i) cmd.params.push_back(cell(i));
+        return cmd;
+    }
+};
+static_assert(std::is_trivially_copyable<CompactCommand>::value, "CompactCommand must stay POD-like");
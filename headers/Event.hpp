@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Small integer id of a command type: state-machine events ("move", "done",
+// ...) and the cursor commands of the local UI. Names are case-insensitive.
+// The built-in ones have fixed ids; any other name found in a
+// transitions.csv is interned when the piece type is loaded.
+using EventId = int16_t;
+
+namespace Events {
+
+constexpr EventId kNone = -1;
+constexpr EventId kDone = 0;
+constexpr EventId kMove = 1;
+constexpr EventId kJump = 2;
+constexpr EventId kIdle = 3;
+// Cursor and player commands (never in a transition table)
+constexpr EventId kUp = 4;
+constexpr EventId kDown = 5;
+constexpr EventId kLeft = 6;
+constexpr EventId kRight = 7;
+constexpr EventId kSelect = 8;
+constexpr EventId kSwitch = 9;
+constexpr EventId kCancel = 10;
+constexpr EventId kConfirm = 11;
+constexpr EventId kBuiltinCount = 12;
+
+// Id of name, assigning the next free one if it is new
+EventId intern(const std::string& name);
+// Id of name, or kNone if it was never interned. Built-in names need no lock.
+EventId find(const std::string& name);
+// Lowercase name of an interned id ("" for kNone or unknown ids)
+const std::string& name(EventId id);
+// One past the largest id handed out so far
+EventId count();
+
+} // namespace Events
@@ -2,6 +2,8 @@
 
 #include "Board.hpp"
 #include "PieceFactory.hpp"
+#include "AssetLoader.hpp"
+#include "AssetBundle.hpp"
 #include <memory>
 #include <vector>
 #include <stdexcept>
@@ -12,6 +14,14 @@
 #include <sstream>
 #include "GraphicsFactory.hpp"
 #include "Common.hpp"
+#include "Occupancy.hpp"
+#include "Clock.hpp"
+#include "Scheduler.hpp"
+#include "SlotMap.hpp"
+#include "SimCore.hpp"
+#include "MpscQueue.hpp"
+#include "UiPump.hpp"
+#include "ThreadPool.hpp"
 #include "img/OpenCvImg.hpp"
 #include <chrono>
 #include <thread>
@@ -43,66 +53,155 @@ public:
 class Game {
 public:
     Game(std::vector<PiecePtr> pcs, Board board);
+    // Hands every piece still referenced elsewhere its own copy of its state
+    ~Game();
 
     // --- main public API ---
     int game_time_ms() const;
     Board clone_board() const;
 
-    // Mirror Python run() behaviour with enhanced threading support
+    // Mirror Python run() behaviour with enhanced threading support.
+    // num_iterations counts simulation ticks; -1 runs until exit.
     void run(int num_iterations = -1, bool is_with_graphics = true);
 
-    std::vector<PiecePtr> pieces;
+    // Live pieces in stable slots; a capture frees its slot in O(1) and any
+    // handle to it stops resolving.
+    SlotMap<PiecePtr> pieces;
     Board board;
     
-    // helper for tests to inject commands
-    void enqueue_command(const Command& cmd);
+    // Stepwise driving, for hosts that run many games (see GameHost):
+    // begin() resets the pieces at the current clock time, advance() runs
+    // up to `ticks` fixed ticks (waiting on the clock between them) and
+    // returns how many ran before the game finished.
+    void begin();
+    int advance(int ticks);
+    bool finished() const;
+    bool won() const { return is_win(); }   // finished by the win condition
+    void stop();                            // safe from any thread
+    int sim_time_ms() const { return sim_now_ms_; }
+
+    // Pool used to update large batches of due pieces in parallel within a
+    // tick (nullptr: always serial). Results are identical either way. The
+    // pool must outlive the game.
+    void set_thread_pool(ThreadPool* pool);
+
+    // Time source for the game loop. With a VirtualClock the loop never
+    // waits: run(n, false) simulates n ticks as fast as the CPU allows.
+    // Call before run().
+    void set_clock(ClockPtr clock);
+
+    // Simulation advances in fixed steps of sim_tick_ms of game time; the
+    // board is redrawn every render_interval_ms of wall time.
+    void set_timing(int sim_tick_ms, int render_interval_ms);
+
+    // Queue a command for the simulation thread. Safe from any thread and
+    // never blocks; returns false (and drops it) if the queue is full. The
+    // Command form is converted on the caller's thread and also returns false
+    // for an unknown piece_id or params CompactCommand cannot hold (more than
+    // two cells, coordinates outside int16); the compact form never allocates.
+    // A command takes effect at the tick that drains it: its timestamp is
+    // replaced by that tick's game time. Piece commands are only accepted
+    // from the piece's owner (player 1 white, player 2 black).
+    bool enqueue_command(const Command& cmd);
+    bool enqueue_command(const CompactCommand& cmd);
+
+    // Handle of the piece with this id (invalid if there is none), for
+    // building CompactCommands. Safe from any thread.
+    PieceHandle handle_of(const std::string& id) const { return find_piece_by_id(id); }
+
+    // Cells currently holding at least one piece, kept in sync every tick
+    const Occupancy& occupancy() const { return occupancy_; }
+    bool is_legal_move(const Piece& piece, const std::pair<int,int>& dst_cell) const;
 
 private:
     // --- helpers mirroring Python implementation ---
-    void start_user_input_thread();
+    void on_key(int key, int timestamp_ms);
     void run_game_loop(int num_iterations, bool is_with_graphics);
-    void update_cell2piece_map();
-    void process_input(const Command& cmd);
+    void step(int now_ms);
+    void update_due(int now_ms);
+    void advance_moves(int now_ms);
+    bool render_frame(int now);
+    void rebuild_occupancy();
+    void sync_piece(PieceHandle h);
+    void grid_insert(PieceHandle h, const std::pair<int,int>& cell);
+    void grid_remove(PieceHandle h, const std::pair<int,int>& cell);
+    void schedule_piece(PieceHandle h, int now_ms);
+    void mark_dirty(const std::pair<int,int>& cell);
+    const std::vector<PieceHandle>* pieces_at(const std::pair<int,int>& cell) const;
+    Piece* resolve(PieceHandle h) const;   // nullptr once captured
+    void process_input(const CompactCommand& cmd);
+    bool is_valid_piece_command(const CompactCommand& cmd) const;
+    static int owner_of(const Piece& piece);   // player id, 0 for neither side
     void resolve_collisions();
     void announce_win() const;
 
     void validate();
     bool is_win() const;
 
-    std::unordered_map<std::string, PiecePtr> piece_by_id;
-    // Map from board cell to list of occupying pieces
-    std::unordered_map<std::pair<int,int>, std::vector<PiecePtr>, PairHash> pos;
+    // Filled once by the constructor and only read afterwards. Captures leave
+    // their entry behind; the stale handle no longer resolves.
+    std::unordered_map<std::string, PieceHandle> piece_by_id;
+    // Dense W x H view of the board (index row * W + col), updated only when
+    // a piece changes cell or state instead of being rebuilt every tick.
+    std::vector<std::vector<PieceHandle>> cell_pieces;
+    Occupancy occupancy_;
+    std::vector<std::pair<int,int>> grid_cell;   // slot index -> cell it is filed under
+    std::vector<int> dirty_cells;        // cells to re-check for captures this tick
+    std::vector<uint8_t> cell_is_dirty;
+
+    // Simulation state of every piece, row == slot index in `pieces`
+    SimCore sim_;
+
+    // Pieces are only updated when their physics deadline comes due, except
+    // moving ones (see advance_moves)
+    DeadlineScheduler scheduler_;
+    std::vector<PieceHandle> due_;
+    std::vector<uint32_t> due_rows_;     // due_ as sim_ rows, grouped by physics kind
+    std::vector<uint8_t> row_changed_;   // per row: changed in the last update
+    std::vector<uint32_t> moved_rows_;   // rows advance_moves changed this tick
+    ThreadPool* pool_ = nullptr;
+    static constexpr size_t kMinUpdateChunk = 32;   // pieces per parallel chunk
+    int sim_now_ms_ = 0;
     
     // Enhanced threading support from CTD25_1
-    std::queue<Command> user_input_queue;
-    std::queue<std::string> string_input_queue;
-    std::mutex queue_mutex_;
-    std::condition_variable cv_;
+    MpscQueue<CompactCommand> input_queue_{1024};
+    CompactCommand input_cmd_;      // reused by the drain in step()
+    int oldest_input_ms_ = -1;      // first input not yet in a presented frame
+    std::unique_ptr<UiPump> ui_;    // window, keyboard and display (graphics only)
     std::atomic<bool> running_{false};
-    std::mutex positions_mutex_;
-    std::mutex input_mutex_;
     
     // Selected piece for user interaction
-    PiecePtr selected_piece_ = nullptr;
+    PieceHandle selected_piece_;
     std::pair<int, int> cursor_pos_ = {0, 0};
     bool is_selecting_target_ = false;
     int current_player_ = 1;  // Current active player
 
-    std::chrono::steady_clock::time_point start_tp;
+    ClockPtr clock_;
+
+    // Loop timing (see set_timing)
+    int sim_tick_ms_ = 5;
+    int render_interval_ms_ = 33;
+    int max_catch_up_ms_ = 250;     // simulated per pass before the next redraw
     
     // Helper functions for user interaction
     void handle_mouse_click(int x, int y);
     void handle_key_press(int key);
+    void click_cell(const std::pair<int,int>& cell);
     void select_piece_at(int x, int y);
     void move_cursor(int dx, int dy);
     void confirm_move();
     void cancel_selection();
     std::string cell_to_chess_notation(int x, int y);
-    PiecePtr find_piece_by_id(const std::string& id);
+    PieceHandle find_piece_by_id(const std::string& id) const;
     void check_captures();
-    void capture_piece(PiecePtr captured, PiecePtr captor);
+    void capture_piece(PieceHandle captured, PieceHandle captor);
     std::string get_position_key(int x, int y);
 };
 
-// Factory function to create game from pieces directory
-Game create_game(const std::string& pieces_root, ImgFactoryPtr img_factory);
\ No newline at end of file
+// Factory function to create game from pieces directory. With lazy_sprites
+// the PNGs are only decoded when a state is first drawn (headless games never
+// decode at all) and are kept in SpriteCache's bounded LRU.
+Game create_game(const std::string& pieces_root, ImgFactoryPtr img_factory, bool lazy_sprites = false);
+
+// Same game, built from a bundle written by kfc_pack (no PNG/JSON parsing)
+Game create_game_from_bundle(const std::string& bundle_path, ImgFactoryPtr img_factory);
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Game.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// GameHost – runs many independent headless games in one process. Each game
+// gets its own VirtualClock and is advanced in slices of ticks, one pool task
+// per game per slice, so games never share a thread at the same time and the
+// pool stays busy as long as any match is live.
+// ---------------------------------------------------------------------------
+class GameHost {
+public:
+    using GameId = uint32_t;
+
+    struct Result {
+        GameId id{0};
+        int ticks{0};          // simulation ticks run
+        int sim_time_ms{0};    // game time when it ended
+        bool won{false};       // ended by the win condition (not the tick limit or stop)
+        size_t pieces_left{0};
+    };
+
+    // threads == 0 uses std::thread::hardware_concurrency()
+    explicit GameHost(unsigned threads = 0);
+
+    // Build a game in place (Game is not movable) and start it. It is retired
+    // after max_ticks ticks, or when it is won or stopped. max_ticks < 0 means
+    // no limit: such a game runs until someone calls stop(id).
+    GameId add_game(std::vector<PiecePtr> pieces, const Board& board, int max_ticks);
+
+    // End a game (e.g. a resignation or a dropped client); it is retired by
+    // the next step_all. Any thread. False if the game is unknown.
+    bool stop(GameId id);
+
+    // Queue a command for one game; any thread. Only holds the host lock for
+    // the lookup, never while games simulate. False if the game is unknown
+    // (or already finished) or its queue is full. The game applies the
+    // command at its own current tick, whatever the timestamp says.
+    bool enqueue(GameId id, const Command& cmd);
+    bool enqueue(GameId id, const CompactCommand& cmd);
+
+    // Advance every live game by up to slice_ticks ticks in parallel, then
+    // retire the finished ones. Returns the number still live.
+    size_t step_all(int slice_ticks = 100);
+
+    // step_all until no game is live. Games without a tick limit must be
+    // stopped from another thread, or this never returns.
+    void run_all(int slice_ticks = 100);
+
+    // Results of the games finished since the last call
+    std::vector<Result> take_results();
+
+    size_t live_games() const;
+    ThreadPool& pool() { return pool_; }
+
+private:
+    struct Match {
+        GameId id;
+        std::unique_ptr<Game> game;
+        int max_ticks;
+        int ticks{0};
+    };
+
+    ThreadPool pool_;
+    mutable std::mutex mutex_;   // matches_ and results_, not the games themselves
+    std::unordered_map<GameId, std::unique_ptr<Match>> matches_;
+    std::vector<Result> results_;
+    GameId next_id_{1};
+};
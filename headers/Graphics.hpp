@@ -2,30 +2,45 @@
 
 #include "img/ImgFactory.hpp"
 #include "Command.hpp"
+#include "SpriteCache.hpp"
 #include <vector>
 #include <string>
 
+// Per-piece animation cursor. Frames and timing live in the shared Graphics.
+struct GraphicsRuntime {
+	int start_ms{ 0 };
+	size_t cur_frame{ 0 };
+};
+
 class Graphics {
 public:
 	Graphics(const std::string& sprites_folder,
 		std::pair<int, int> cell_size,
 		ImgFactoryPtr img_factory,
 		bool loop = true,
-		double fps = 0.2);
+		double fps = 0.2,
+		bool lazy = false);   // lazy: only record paths, decode on first get_img
+	Graphics(FrameSetPtr frames, bool loop = true, double fps = 0.2);
+
+	void reset(GraphicsRuntime& rt, const CompactCommand& cmd) const;
+	void update(GraphicsRuntime& rt, int now_ms) const;
+	const ImgPtr get_img(const GraphicsRuntime& rt) const;
 
-	void reset(const Command& cmd);
-	void update(int now_ms);
-	const ImgPtr get_img() const;
+	size_t frame_count() const { return lazy ? frame_paths.size() : frames->size(); }
 
 	// Test helpers ---------------------------------------------------------
-	size_t current_frame() const { return cur_frame; }
-	void set_frames(const std::vector<ImgPtr>& new_frames) { frames = new_frames; }
+	void set_frames(const std::vector<ImgPtr>& new_frames) { frames = std::make_shared<const FrameSet>(new_frames); }
 
 private:
-	std::vector<ImgPtr> frames;
+	FrameSetPtr frames;   // shared with every Graphics of the same sprites folder
+
+	// Lazy mode: frames stay encoded until drawn, then live in SpriteCache's LRU
+	bool lazy{ false };
+	std::string sprites_folder;             // canonical
+	std::vector<std::string> frame_paths;
+	std::pair<int, int> cell_size{ 0, 0 };
+	ImgFactoryPtr img_factory;
 	bool loop{ true };
 	double fps{ 0.2 };
-	int start_ms{ 0 };
-	size_t cur_frame{ 0 };
 	double frame_duration_ms{ 0 };
-};
\ No newline at end of file
+};
@@ -12,17 +12,27 @@
 // factory mirrors the Python API expected by the unit tests.
 class GraphicsFactory {
 public:
-    explicit GraphicsFactory(ImgFactoryPtr factory_ptr = nullptr)
-        : img_factory(factory_ptr) {}
+    // lazy_sprites: Graphics only record frame paths and decode on first draw
+    explicit GraphicsFactory(ImgFactoryPtr factory_ptr = nullptr, bool lazy_sprites = false)
+        : img_factory(factory_ptr), lazy_sprites(lazy_sprites) {}
+
+    bool is_lazy() const { return lazy_sprites; }
 
     std::shared_ptr<Graphics> load(const std::string& sprites_dir,
                                    const nlohmann::json& /*cfg*/, // ignored
                                    std::pair<int,int> cell_size) const {
         // For now, create a Graphics object with blank frames produced by img_factory
-        auto gfx = std::make_shared<Graphics>(sprites_dir, cell_size, img_factory, /*loop*/true, /*fps*/6.0);
+        auto gfx = std::make_shared<Graphics>(sprites_dir, cell_size, img_factory, /*loop*/true, /*fps*/6.0, lazy_sprites);
         (void)cell_size; // unused for now
         return gfx;
     }
+
+    // Same timing as above, over frames that are already decoded (bundles).
+    std::shared_ptr<Graphics> load(FrameSetPtr frames,
+                                   const nlohmann::json& /*cfg*/) const {
+        return std::make_shared<Graphics>(frames, /*loop*/true, /*fps*/6.0);
+    }
 private:
     ImgFactoryPtr img_factory;
+    bool lazy_sprites{false};
 };
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+enum class LogLevel : int { Trace = 0, Debug, Info, Warn, Error, Off };
+
+// Messages below this level are compiled out entirely (their arguments are
+// never evaluated). Release builds raise it from CMake.
+#ifndef KFC_LOG_MIN_LEVEL
+#define KFC_LOG_MIN_LEVEL 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KFC_PRINTF_FORMAT(fmt_idx, args_idx) __attribute__((format(printf, fmt_idx, args_idx)))
+#else
+#define KFC_PRINTF_FORMAT(fmt_idx, args_idx)
+#endif
+
+// ---------------------------------------------------------------------------
+// Log – process-wide asynchronous logger. write() formats into a fixed slot
+// of a lock-free ring and returns; a background thread drains the ring to
+// stdout (stderr for warnings and errors). Nothing is allocated per message,
+// callers never block, and a full ring drops the message (and counts it).
+// The runtime level starts from $KFC_LOG_LEVEL (trace..error, off), else info.
+// ---------------------------------------------------------------------------
+class Log {
+public:
+    static Log& instance();
+
+    void set_level(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+    bool enabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    void write(LogLevel level, const char* fmt, ...) KFC_PRINTF_FORMAT(3, 4);
+
+    // Block until everything written so far has reached the output
+    void flush();
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    ~Log();
+
+private:
+    Log();
+    Log(const Log&) = delete;
+    Log& operator=(const Log&) = delete;
+
+    static constexpr size_t kCapacity = 4096;   // slots, power of two
+    static constexpr size_t kSlotBytes = 256;   // per message, truncated beyond
+
+    struct Slot {
+        std::atomic<uint64_t> seq;
+        LogLevel level;
+        char text[kSlotBytes];
+    };
+
+    void drain_loop();
+    bool drain_some();
+
+    std::unique_ptr<Slot[]> ring_;
+    std::atomic<uint64_t> tail_{0};       // next slot producers claim
+    std::atomic<uint64_t> drained_{0};    // next slot the drain thread reads
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<int> level_{static_cast<int>(LogLevel::Info)};
+    std::atomic<bool> stop_{false};
+    std::thread worker_;
+};
+
+#define KFC_LOG(lvl, ...)                                                     \
+    do {                                                                      \
+        if constexpr(static_cast<int>(lvl) >= KFC_LOG_MIN_LEVEL) {            \
+            if(Log::instance().enabled(lvl)) Log::instance().write(lvl, __VA_ARGS__); \
+        }                                                                     \
+    } while(0)
+
+#define KFC_LOG_TRACE(...) KFC_LOG(LogLevel::Trace, __VA_ARGS__)
+#define KFC_LOG_DEBUG(...) KFC_LOG(LogLevel::Debug, __VA_ARGS__)
+#define KFC_LOG_INFO(...)  KFC_LOG(LogLevel::Info, __VA_ARGS__)
+#define KFC_LOG_WARN(...)  KFC_LOG(LogLevel::Warn, __VA_ARGS__)
+#define KFC_LOG_ERROR(...) KFC_LOG(LogLevel::Error, __VA_ARGS__)
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Allocator for Align-byte aligned blocks, so that each integrator column
+// starts on a cache line / vector register boundary.
+template <typename T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    // C++17 aligned operator new: portable, unlike std::aligned_alloc,
+    // which MSVC's runtime does not provide
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+    }
+    void deallocate(T* p, size_t n) { ::operator delete(p, n * sizeof(T), std::align_val_t{Align}); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+// ---------------------------------------------------------------------------
+// MoveIntegrator – every in-flight move of a SimCore as aligned parallel int32
+// arrays, in Q16.16 fixed-point cell units. advance() integrates all of them
+// in one branch-free pass per tick over __restrict columns, a shape compilers
+// can auto-vectorize (GCC does at -O3), and then reports the rows that
+// changed cell or arrived. Integer math makes the result bit-exact on every
+// machine, and MovePhysics uses the same helpers, so a single-row update
+// agrees with the batch. Moves span at most kMaxCells cells per axis, so that
+// vel * t in position() fits in 32 bits; add() rejects longer ones.
+// ---------------------------------------------------------------------------
+class MoveIntegrator {
+public:
+    using Cell = std::pair<int,int>;   // (row, col)
+
+    static constexpr int kFracBits = 16;
+    static constexpr int32_t kOne = 1 << kFracBits;   // one cell
+    static constexpr int kVelBits = 6;                // extra velocity precision
+    static constexpr int kMaxCells = (1 << (31 - kFracBits - kVelBits)) - 1;   // per axis: 511
+
+    // --- fixed-point helpers, per axis ---
+    static int32_t to_q(int cell) { return cell * kOne; }
+    static int to_cell(int32_t pos_q) { return (pos_q + kOne / 2) >> kFracBits; }
+    // Q16.16 cells per ms, scaled by 2^kVelBits
+    static int32_t velocity(int32_t delta_q, int dur_ms) {
+        return dur_ms > 0 ? static_cast<int32_t>((static_cast<int64_t>(delta_q) * (1 << kVelBits)) / dur_ms) : 0;
+    }
+    // t_ms in [0, dur_ms)
+    static int32_t position(int32_t start_q, int32_t vel, int32_t t_ms) {
+        return start_q + ((vel * t_ms) >> kVelBits);
+    }
+
+    struct Event {
+        uint32_t row;
+        Cell cell;          // cell after this tick
+        bool arrived;       // the move is over; the row is still registered
+        int32_t x_q, y_q;   // position (col, row axes)
+    };
+
+    static bool in_range(Cell start, Cell end) {
+        return std::abs(end.first - start.first) <= kMaxCells && std::abs(end.second - start.second) <= kMaxCells;
+    }
+
+    // Register (or replace) the move of `row`. Throws std::invalid_argument
+    // if the move is longer than kMaxCells on either axis.
+    void add(uint32_t row, Cell start, Cell end, int start_ms, int dur_ms);
+    void remove(uint32_t row);   // no-op if the row is not moving
+    void clear();
+    size_t size() const { return rows_.size(); }
+
+    // Advance every move to now_ms and append an Event for each one that
+    // changed cell or arrived, in registration-slot order.
+    void advance(int now_ms, std::vector<Event>& out);
+
+private:
+    template <typename T> using Column = std::vector<T, AlignedAllocator<T>>;
+
+    Column<int32_t> start_ms_, dur_ms_;
+    Column<int32_t> x0_, y0_, x1_, y1_;   // start and end, Q16.16
+    Column<int32_t> vx_, vy_;
+    Column<int32_t> x_, y_;               // position after the last advance
+    Column<int32_t> col_, row_;           // cell after the last advance
+    Column<int32_t> flags_;               // per slot: kMoved | kArrived
+    static constexpr int32_t kMoved = 1, kArrived = 2;
+    std::vector<uint32_t> rows_;          // slot -> SimCore row
+    std::vector<int32_t> slot_of_;        // SimCore row -> slot, -1 if not moving
+};
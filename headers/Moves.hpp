@@ -5,6 +5,8 @@
 #include <unordered_set>
 #include <utility>
 #include "Common.hpp"
+#include "Occupancy.hpp"
+#include <cstdint>
 
 class Moves {
 public:
@@ -12,17 +14,49 @@ public:
     struct RelMove { int dr; int dc; int tag; };
 
     Moves(const std::string& txt_path, std::pair<int,int> board_dims);
+    Moves(std::vector<RelMove> moves, std::pair<int,int> board_dims);
+
+    const std::vector<RelMove>& relative_moves() const { return rel_moves; }
 
     bool is_dst_cell_valid(int dr, int dc, bool dst_has_piece) const;
     bool is_valid(const std::pair<int,int>& src_cell,
                   const std::pair<int,int>& dst_cell,
                   const std::unordered_set<std::pair<int,int>, PairHash>& cell_with_piece) const;
 
+    // Bitboard engine: same answer as above from the per-square tables built
+    // at construction – one offset lookup, one bit test and one ray-mask AND.
+    // The occupancy must have the board dimensions given to the constructor.
+    bool is_valid(const std::pair<int,int>& src_cell,
+                  const std::pair<int,int>& dst_cell,
+                  const Occupancy& occupancy) const;
+
+    // Every legal destination from src, written to out[0..n) in rel_moves
+    // order; returns n. Never allocates: at most `capacity` cells are written,
+    // and max_destinations() is always enough.
+    size_t generate(const std::pair<int,int>& src_cell,
+                    const Occupancy& occupancy,
+                    std::pair<int,int>* out,
+                    size_t capacity) const;
+    size_t max_destinations() const { return rel_moves.size(); }
+
 private:
     std::vector<RelMove> rel_moves;
     int W; int H;
 
+    // Bitboard tables ------------------------------------------------------
+    std::vector<int16_t> offset_to_move;   // (2H-1)x(2W-1): first rel_move per (dr,dc), -1 none
+    size_t mask_words{0};
+    std::vector<uint64_t> ray_masks;       // [square][move]: cells strictly between src and dst
+    std::vector<std::pair<int,int>> ray_steps;   // (dr,dc) of each intermediate cell, all moves
+    std::vector<uint32_t> ray_begin;             // move m owns ray_steps[ray_begin[m], ray_begin[m+1])
+
     static RelMove parse_line(const std::string& s);
+    void build_tables();
+    static void append_steps(int dr, int dc, std::vector<std::pair<int,int>>& out);
+    int move_index(int dr, int dc) const;
+    void check_dims(const Occupancy& occupancy) const;
+    bool passes(int src_index, int move, const std::pair<int,int>& dst_cell,
+                const Occupancy& occupancy) const;
 
     bool path_is_clear(const std::pair<int,int>& src_cell,
                        const std::pair<int,int>& dst_cell,
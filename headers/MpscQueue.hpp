@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// ---------------------------------------------------------------------------
+// MpscQueue – bounded lock-free queue for many producers and one consumer.
+// All slots are allocated up front (T must be default-constructible); a push
+// claims a slot with one CAS and moves the value in, a pop moves it out.
+// Neither side ever blocks: try_push fails when the queue is full and
+// try_pop fails when it is empty.
+// ---------------------------------------------------------------------------
+template <typename T>
+class MpscQueue {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) {
+        size_t n = 1;
+        while(n < capacity) n <<= 1;
+        mask = n - 1;
+        slots.reset(new Slot[n]);
+        for(size_t i = 0; i < n; ++i) slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    bool try_push(T value) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for(;;) {
+            slot = &slots[pos & mask];
+            uint64_t seq = slot->seq.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if(diff == 0) {
+                if(tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if(diff < 0) {
+                return false;   // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool try_pop(T& out) {
+        Slot& slot = slots[head & mask];
+        if(slot.seq.load(std::memory_order_acquire) != head + 1) return false;
+        out = std::move(slot.value);
+        slot.seq.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask{0};
+    alignas(64) std::atomic<uint64_t> tail{0};   // producers
+    alignas(64) uint64_t head{0};                // consumer
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Occupancy – one bit per board cell, row-major (index = row * W + col).
+// Boards of up to 64 cells (the 8x8 board) fit a single 64-bit bitboard;
+// larger variants use as many words as needed.
+// ---------------------------------------------------------------------------
+class Occupancy {
+public:
+    using Cell = std::pair<int,int>;   // (row, col)
+
+    Occupancy(int W, int H)
+        : W(W), H(H), words(word_count_for(W, H), 0) {}
+
+    static size_t word_count_for(int W, int H) {
+        return (static_cast<size_t>(W) * static_cast<size_t>(H) + 63) / 64;
+    }
+
+    int width() const { return W; }
+    int height() const { return H; }
+    size_t word_count() const { return words.size(); }
+    bool single_word() const { return words.size() == 1; }
+    const uint64_t* data() const { return words.data(); }
+
+    bool in_bounds(const Cell& cell) const {
+        return cell.first >= 0 && cell.first < H && cell.second >= 0 && cell.second < W;
+    }
+    int index(const Cell& cell) const { return cell.first * W + cell.second; }
+
+    void set(const Cell& cell) {
+        if(!in_bounds(cell)) return;
+        int i = index(cell);
+        words[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+    void clear(const Cell& cell) {
+        if(!in_bounds(cell)) return;
+        int i = index(cell);
+        words[i >> 6] &= ~(uint64_t(1) << (i & 63));
+    }
+    bool test(const Cell& cell) const {
+        if(!in_bounds(cell)) return false;
+        return test_index(index(cell));
+    }
+    bool test_index(int i) const { return (words[i >> 6] >> (i & 63)) & 1u; }
+
+    void reset() { std::fill(words.begin(), words.end(), 0); }
+
+    // True if any bit of `mask` (word_count() words) is occupied.
+    bool intersects(const uint64_t* mask) const {
+        if(single_word()) return (mask[0] & words[0]) != 0;
+        for(size_t w = 0; w < words.size(); ++w) {
+            if(mask[w] & words[w]) return true;
+        }
+        return false;
+    }
+
+private:
+    int W;
+    int H;
+    std::vector<uint64_t> words;
+};
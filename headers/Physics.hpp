@@ -3,58 +3,102 @@
 #include "Board.hpp"
 #include "Command.hpp"
 #include "Common.hpp"
+#include "MoveIntegrator.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <variant>
+#include <vector>
 
+// Order matches the alternatives of Physics::Variant
+enum class PhysicsKind : uint8_t { Idle, Move, StaticTemporary, Jump, Rest };
+
+// Per-piece mutable physics state, one column per field and one row per
+// piece (see SimCore). The behaviour and its parameters live in the
+// BasePhysics shared by every piece of the same type and state.
+struct PhysicsColumns {
+    std::vector<std::pair<int,int>> start_cell;
+    std::vector<std::pair<int,int>> end_cell;
+    std::vector<std::pair<double,double>> curr_pos_m;
+    std::vector<int> start_ms;
+
+    // MovePhysics only: whole milliseconds from start to arrival
+    std::vector<int> duration_ms;
+
+    size_t size() const { return start_ms.size(); }
+
+    void resize(size_t rows) {
+        start_cell.resize(rows, {0,0});
+        end_cell.resize(rows, {0,0});
+        curr_pos_m.resize(rows, {0.0,0.0});
+        start_ms.resize(rows, 0);
+        duration_ms.resize(rows, 0);
+    }
+
+    void copy_row(const PhysicsColumns& from, uint32_t src, uint32_t dst) {
+        start_cell[dst]   = from.start_cell[src];
+        end_cell[dst]     = from.end_cell[src];
+        curr_pos_m[dst]   = from.curr_pos_m[src];
+        start_ms[dst]     = from.start_ms[src];
+        duration_ms[dst]  = from.duration_ms[src];
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Physics kinds are a closed set of plain classes (no virtuals). Each one
+// provides
+//   void reset(PhysicsColumns&, uint32_t row, const CompactCommand&) const;
+//   EventId update(PhysicsColumns&, uint32_t row, int now_ms) const;
+//       – the event the piece raises at now_ms (e.g. "done"), else kNone
+//   int next_deadline_ms(const PhysicsColumns&, uint32_t row, int now_ms) const;
+// and its capture rules as constants. They are held by value in Physics.
+// ---------------------------------------------------------------------------
 class BasePhysics {
 public:
     explicit BasePhysics(const Board& board, double param = 1.0)
         : board(board), param(param) {}
 
-    virtual ~BasePhysics() = default;
-
-    virtual void reset(const Command& cmd) = 0;
-    // Update physics state. Return a Command if one is produced, otherwise nullptr
-    virtual std::shared_ptr<Command> update(int now_ms) = 0;
-
-    std::pair<double,double> get_pos_m() const { return curr_pos_m; }
-    std::pair<int,int> get_pos_pix() const { return board.m_to_pix(curr_pos_m); }
-    std::pair<int,int> get_curr_cell() const { return board.m_to_cell(curr_pos_m); }
+    // Earliest time after now_ms at which update() can produce a command or
+    // move the piece to another cell; kNoDeadline if it never will. Waking a
+    // piece early is harmless, waking it late is not.
+    static constexpr int kNoDeadline = std::numeric_limits<int>::max();
+    int next_deadline_ms(const PhysicsColumns&, uint32_t /*row*/, int /*now_ms*/) const { return kNoDeadline; }
 
-    int get_start_ms() const { return start_ms; }
+    std::pair<int,int> get_pos_pix(const PhysicsColumns& rt, uint32_t row) const { return board.m_to_pix(rt.curr_pos_m[row]); }
+    std::pair<int,int> get_curr_cell(const PhysicsColumns& rt, uint32_t row) const { return board.m_to_cell(rt.curr_pos_m[row]); }
 
-    virtual bool can_be_captured() const { return true; }
-    virtual bool can_capture() const { return true; }
-    virtual bool is_movement_blocker() const { return false; }
+    static constexpr bool kCanBeCaptured = true;
+    static constexpr bool kCanCapture = true;
+    static constexpr bool kMovementBlocker = false;
 
 public:
-    const Board& board;
+    // Held by value: templates are shared across games and outlive the
+    // Board that PieceFactory was given.
+    Board board;
     double param{1.0};
-
-    std::pair<int,int> start_cell{0,0};
-    std::pair<int,int> end_cell{0,0};
-    std::pair<double,double> curr_pos_m{0.0,0.0};
-    int start_ms{0};
 };
 
 // ---------------------------------------------------------------------------
 class IdlePhysics : public BasePhysics {
 public:
     using BasePhysics::BasePhysics;
-    void reset(const Command& cmd) override {
-        if(cmd.type == "done") {
-            end_cell = start_cell;
-        } else if(!cmd.params.empty()) {
-            start_cell = end_cell = cmd.params[0];
-            curr_pos_m = board.cell_to_m(start_cell);
+
+    void reset(PhysicsColumns& rt, uint32_t row, const CompactCommand& cmd) const {
+        if(cmd.event == Events::kDone) {
+            rt.end_cell[row] = rt.start_cell[row];
+        } else if(cmd.cell_count > 0) {
+            rt.start_cell[row] = rt.end_cell[row] = cmd.cell(0);
+            rt.curr_pos_m[row] = board.cell_to_m(rt.start_cell[row]);
         }
         // Don't change position if no params - keep existing position
-        start_ms = cmd.timestamp;
+        rt.start_ms[row] = cmd.timestamp;
     }
-    std::shared_ptr<Command> update(int) override { return nullptr; }
+    EventId update(PhysicsColumns&, uint32_t, int) const { return Events::kNone; }
 
-    bool can_capture() const override { return false; }
-    bool is_movement_blocker() const override { return true; }
+    static constexpr bool kCanCapture = false;
+    static constexpr bool kMovementBlocker = true;
 };
 
 // ---------------------------------------------------------------------------
@@ -63,39 +107,75 @@ public:
     explicit MovePhysics(const Board& board, double speed_cells_per_s)
         : BasePhysics(board, speed_cells_per_s) {}
 
-    void reset(const Command& cmd) override {
-        start_cell = cmd.params[0];
-        end_cell   = cmd.params[1];
-        curr_pos_m = board.cell_to_m(start_cell);
-        start_ms   = cmd.timestamp;
+    void reset(PhysicsColumns& rt, uint32_t row, const CompactCommand& cmd) const {
+        rt.start_cell[row] = cmd.cell(0);
+        rt.end_cell[row]   = cmd.cell(1);
+        rt.start_ms[row]   = cmd.timestamp;
 
-        std::pair<double,double> start_pos = board.cell_to_m(start_cell);
-        std::pair<double,double> end_pos   = board.cell_to_m(end_cell);
-        movement_vec = { end_pos.first - start_pos.first, end_pos.second - start_pos.second };
-        movement_len = std::hypot(movement_vec.first, movement_vec.second);
+        std::pair<double,double> start_pos = board.cell_to_m(rt.start_cell[row]);
+        std::pair<double,double> end_pos   = board.cell_to_m(rt.end_cell[row]);
+        rt.curr_pos_m[row] = start_pos;
+        double movement_len = std::hypot(end_pos.first - start_pos.first, end_pos.second - start_pos.second);
         double speed_m_s = param; // 1 cell == 1m with default cell_size_m
-        duration_s = movement_len / speed_m_s;
+        // First whole millisecond at which the piece has arrived
+        rt.duration_ms[row] = static_cast<int>(std::ceil(movement_len / speed_m_s * 1000.0));
     }
 
-    std::shared_ptr<Command> update(int now_ms) override {
-        double seconds = (now_ms - start_ms) / 1000.0;
-        if(seconds >= duration_s) {
-            curr_pos_m = board.cell_to_m(end_cell);
-            return std::make_shared<Command>(Command{now_ms, "", "done", {}});
+    // Same fixed-point interpolation as MoveIntegrator::advance, so a row
+    // updated on its own lands exactly where the batch would put it.
+    EventId update(PhysicsColumns& rt, uint32_t row, int now_ms) const {
+        int t = now_ms - rt.start_ms[row];
+        if(t >= rt.duration_ms[row]) {
+            rt.curr_pos_m[row] = board.cell_to_m(rt.end_cell[row]);
+            return Events::kDone;
         }
-        double ratio = seconds / duration_s;
-        curr_pos_m = { board.cell_to_m(start_cell).first + movement_vec.first * ratio,
-                       board.cell_to_m(start_cell).second + movement_vec.second * ratio };
-        return nullptr;
+        auto pos = pos_q(rt, row, t);
+        rt.curr_pos_m[row] = to_m(pos.first, pos.second);
+        return Events::kNone;
+    }
+
+    // The first millisecond at which the fixed-point position rounds to
+    // another cell, or arrival, whichever is first. Along a straight move
+    // each axis is monotone, so once the cell differs it stays different
+    // and a binary search over the remaining milliseconds finds it.
+    int next_deadline_ms(const PhysicsColumns& rt, uint32_t row, int now_ms) const {
+        const int start_ms = rt.start_ms[row];
+        const int dur = rt.duration_ms[row];
+        int t = std::max(0, now_ms - start_ms);
+        if(t >= dur) return start_ms + dur;
+        auto cell_at = [&](int at) {
+            auto pos = pos_q(rt, row, at);
+            return std::make_pair(MoveIntegrator::to_cell(pos.second), MoveIntegrator::to_cell(pos.first));
+        };
+        const auto cell_now = cell_at(t);
+        int lo = t, hi = dur;   // cell_at(lo) == cell_now; at hi the move is over
+        while(hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            if(cell_at(mid) == cell_now) lo = mid; else hi = mid;
+        }
+        return start_ms + hi;
+    }
+
+    // Meters of a fixed-point position (x along columns, y along rows)
+    std::pair<double,double> to_m(int32_t x_q, int32_t y_q) const {
+        return { board.cell_W_m * (x_q / static_cast<double>(MoveIntegrator::kOne)),
+                 board.cell_H_m * (y_q / static_cast<double>(MoveIntegrator::kOne)) };
     }
 
-private:
-    std::pair<double,double> movement_vec{0.f,0.f};
-    double movement_len{0};
-    double duration_s{1.0};
-public:
     double get_speed_m_s() const { return param; }
-    double get_duration_s() const { return duration_s; }
+
+private:
+    // Q16.16 position t ms (0 <= t < duration) into the move of `row`
+    std::pair<int32_t,int32_t> pos_q(const PhysicsColumns& rt, uint32_t row, int t) const {
+        using MI = MoveIntegrator;
+        const auto& from = rt.start_cell[row];
+        const auto& to = rt.end_cell[row];
+        int32_t x0 = MI::to_q(from.second), y0 = MI::to_q(from.first);
+        int dur = rt.duration_ms[row];
+        t = std::max(0, t);
+        return { MI::position(x0, MI::velocity(MI::to_q(to.second) - x0, dur), t),
+                 MI::position(y0, MI::velocity(MI::to_q(to.first) - y0, dur), t) };
+    }
 }; // end MovePhysics
 
 // ---------------------------------------------------------------------------
@@ -104,31 +184,91 @@ public:
     using BasePhysics::BasePhysics;
     double get_duration_s() const { return param; }
 
-    void reset(const Command& cmd) override {
-        start_cell = end_cell = cmd.params[0];
-        curr_pos_m = board.cell_to_m(start_cell);
-        start_ms   = cmd.timestamp;
+    void reset(PhysicsColumns& rt, uint32_t row, const CompactCommand& cmd) const {
+        // A "done" from the previous state carries no cell: stay where we are
+        rt.start_cell[row] = rt.end_cell[row] = cmd.cell_count == 0 ? rt.end_cell[row] : cmd.cell(0);
+        rt.curr_pos_m[row] = board.cell_to_m(rt.start_cell[row]);
+        rt.start_ms[row]   = cmd.timestamp;
     }
 
-    std::shared_ptr<Command> update(int now_ms) override {
-        double seconds = (now_ms - start_ms) / 1000.0;
-        if(seconds >= param) {
-            return std::make_shared<Command>(Command{now_ms, "", "done", {}});
-        }
-        return nullptr;
+    EventId update(PhysicsColumns& rt, uint32_t row, int now_ms) const {
+        double seconds = (now_ms - rt.start_ms[row]) / 1000.0;
+        return seconds >= param ? Events::kDone : Events::kNone;
+    }
+
+    int next_deadline_ms(const PhysicsColumns& rt, uint32_t row, int) const {
+        return rt.start_ms[row] + static_cast<int>(std::ceil(param * 1000.0));
     }
 
-    bool is_movement_blocker() const override { return true; }
+    static constexpr bool kMovementBlocker = true;
 };
 
 class JumpPhysics : public StaticTemporaryPhysics {
 public:
     using StaticTemporaryPhysics::StaticTemporaryPhysics;
-    bool can_be_captured() const override { return false; }
+    static constexpr bool kCanBeCaptured = false;
 };
 
 class RestPhysics : public StaticTemporaryPhysics {
 public:
     using StaticTemporaryPhysics::StaticTemporaryPhysics;
-    bool can_capture() const override { return false; }
+    static constexpr bool kCanCapture = false;
+};
+
+// ---------------------------------------------------------------------------
+// Physics – one of the kinds above, by value. The generic calls dispatch
+// through std::visit; batch code that already knows the kind (see SimCore)
+// uses as<P>() and calls the concrete class directly.
+// ---------------------------------------------------------------------------
+class Physics {
+public:
+    using Variant = std::variant<IdlePhysics, MovePhysics, StaticTemporaryPhysics, JumpPhysics, RestPhysics>;
+
+    template <typename P>
+    Physics(P p) : v(std::move(p)) {}
+
+    PhysicsKind kind() const { return static_cast<PhysicsKind>(v.index()); }
+
+    template <typename P>
+    const P& as() const { return *std::get_if<P>(&v); }
+
+    const BasePhysics& base() const {
+        return std::visit([](const auto& p) -> const BasePhysics& { return p; }, v);
+    }
+    const Board& board() const { return base().board; }
+
+    void reset(PhysicsColumns& rt, uint32_t row, const CompactCommand& cmd) const {
+        std::visit([&](const auto& p) { p.reset(rt, row, cmd); }, v);
+    }
+    EventId update(PhysicsColumns& rt, uint32_t row, int now_ms) const {
+        return std::visit([&](const auto& p) { return p.update(rt, row, now_ms); }, v);
+    }
+    int next_deadline_ms(const PhysicsColumns& rt, uint32_t row, int now_ms) const {
+        return std::visit([&](const auto& p) { return p.next_deadline_ms(rt, row, now_ms); }, v);
+    }
+    std::pair<int,int> get_curr_cell(const PhysicsColumns& rt, uint32_t row) const {
+        return base().get_curr_cell(rt, row);
+    }
+
+    bool can_be_captured() const { return flags(kCanBeCapturedFlag); }
+    bool can_capture() const { return flags(kCanCaptureFlag); }
+    bool is_movement_blocker() const { return flags(kMovementBlockerFlag); }
+
+private:
+    enum : uint8_t { kCanBeCapturedFlag = 1, kCanCaptureFlag = 2, kMovementBlockerFlag = 4 };
+    template <typename P>
+    static constexpr uint8_t flags_of() {
+        return (P::kCanBeCaptured ? kCanBeCapturedFlag : 0) | (P::kCanCapture ? kCanCaptureFlag : 0)
+             | (P::kMovementBlocker ? kMovementBlockerFlag : 0);
+    }
+    // Indexed by kind, so the capture checks are a table lookup
+    bool flags(uint8_t flag) const {
+        static constexpr uint8_t table[] = {
+            flags_of<IdlePhysics>(), flags_of<MovePhysics>(), flags_of<StaticTemporaryPhysics>(),
+            flags_of<JumpPhysics>(), flags_of<RestPhysics>()
+        };
+        return (table[v.index()] & flag) != 0;
+    }
+
+    Variant v;
 };
\ No newline at end of file
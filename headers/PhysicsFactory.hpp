@@ -5,7 +5,7 @@
 #include "nlohmann/json.hpp"
 
 // ---------------------------------------------------------------------------
-// PhysicsFactory – helper that instantiates physics subclasses from a string
+// PhysicsFactory – helper that builds a Physics of the kind named by a string
 // identifier and optional JSON-like configuration, mirroring the Python
 // PhysicsFactory used in tests.
 // ---------------------------------------------------------------------------
@@ -13,27 +13,27 @@ class PhysicsFactory {
 public:
     explicit PhysicsFactory(const Board& board) : board(board) {}
 
-    std::shared_ptr<BasePhysics> create(const std::pair<int,int>& /*start_cell*/,
-                                        const std::string& name,
-                                        const nlohmann::json& cfg) const {
+    Physics create(const std::pair<int,int>& /*start_cell*/,
+                   const std::string& name,
+                   const nlohmann::json& cfg) const {
         std::string key = to_lower(name);
         if(key == "idle") {
-            return std::make_shared<IdlePhysics>(board);
+            return IdlePhysics(board);
         }
         if(key == "move") {
             double speed = cfg.is_null() ? 1.0 : cfg.value("speed_m_per_sec", 1.0);
-            return std::make_shared<MovePhysics>(board, speed);
+            return MovePhysics(board, speed);
         }
         if(key == "jump") {
             double duration_ms = cfg.is_null() ? 50.0 : cfg.value("duration_ms", 50.0);
-            return std::make_shared<JumpPhysics>(board, duration_ms / 1000.0);
+            return JumpPhysics(board, duration_ms / 1000.0);
         }
         if(key.find("rest") != std::string::npos) {
             double duration_ms = cfg.is_null() ? 500.0 : cfg.value("duration_ms", 500.0);
-            return std::make_shared<RestPhysics>(board, duration_ms / 1000.0);
+            return RestPhysics(board, duration_ms / 1000.0);
         }
         // fallback idle
-        return std::make_shared<IdlePhysics>(board);
+        return IdlePhysics(board);
     }
 private:
     const Board& board;
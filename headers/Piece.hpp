@@ -1,6 +1,7 @@
 #pragma once
 
 #include "State.hpp"
+#include "SimCore.hpp"
 #include "Command.hpp"
 #include <memory>
 #include <unordered_map>
@@ -13,37 +14,79 @@ typedef std::shared_ptr<Piece> PiecePtr;
 
 class Piece {
 public:
-	Piece(std::string id, std::shared_ptr<State> init_state)
-		: id(id), state(init_state) {}
+	Piece(std::string id, PieceTemplatePtr tmpl)
+		: id(id), tmpl(tmpl), own_core(std::make_unique<SimCore>()), core(own_core.get()) {
+		core->resize(1);
+		core->init_row(0, *this->tmpl);
+	}
 
 	std::string id;
-	std::shared_ptr<State> state;
+	PieceTemplatePtr tmpl;   // shared, immutable state graph of this piece type
 
 	using Cell = std::pair<int, int>;
 	using Cell2Pieces = std::unordered_map<Cell, std::vector<PiecePtr>, PairHash>;
 
+	// This piece's current state, timers and position live in row `row` of
+	// a SimCore; everything below reads and writes through it.
+	const StateTemplate& state() const { return core->state(row); }
+	int state_id() const { return core->state_id[row]; }
+
+	// Move this piece's row into `target` at `target_row` (Game does this for
+	// every piece it owns). detach() copies it back into a private core, so
+	// the piece stays usable after the game drops it.
+	void bind(SimCore& target, uint32_t target_row) {
+		target.copy_row(*core, row, target_row);
+		core = &target;
+		row = target_row;
+		own_core.reset();
+	}
+	void detach() {
+		if(own_core) return;
+		auto mine = std::make_unique<SimCore>();
+		mine->resize(1);
+		mine->copy_row(*core, row, 0);
+		own_core = std::move(mine);
+		core = own_core.get();
+		row = 0;
+	}
+
 	void on_command(const Command& cmd, Cell2Pieces&) {
-		state = state->on_command(cmd);
+		core->transition(row, CompactCommand::from(cmd));
 	}
+	void on_command(const Command& cmd) { core->transition(row, CompactCommand::from(cmd)); }
+	void on_command(const CompactCommand& cmd) { core->transition(row, cmd); }
 
 	void reset(int start_ms) {
 		auto cell = this->current_cell();
-		Command cmd{ start_ms,id,"Idle",{cell} };
-		state->reset(cmd);
+		auto cmd = CompactCommand::make(start_ms, Events::kIdle).add_cell(cell);
+		core->enter(row, core->state_id[row], cmd);
 	}
 
-	void update(int now_ms) {
-		state = state->update(now_ms);
+	// Returns true if the piece changed cell or state, i.e. whenever the
+	// game's occupancy view of it may be stale.
+	bool update(int now_ms) { return core->update(row, now_ms); }
+
+	// Place the piece on a cell without going through a state transition.
+	void place_at(const Cell& cell) {
+		core->physics.start_cell[row] = cell;
+		core->physics.end_cell[row] = cell;
+		core->physics.curr_pos_m[row] = state().physics.board().cell_to_m(cell);
 	}
 
-	bool is_movement_blocker() const { return state->physics->is_movement_blocker(); }
+	// When update() next needs to run (see BasePhysics::next_deadline_ms)
+	int next_deadline_ms(int now_ms) const { return core->next_deadline_ms(row, now_ms); }
 
-	Cell current_cell() const { 
-		auto cell = state->physics->get_curr_cell();
-		// Check for invalid values and use fallback
-		if (cell.first < -1000000 || cell.second < -1000000) {
-			return state->physics->start_cell;
-		}
-		return cell;
-	}
-};
\ No newline at end of file
+	void update_graphics(int now_ms) { state().graphics->update(core->graphics[row], now_ms); }
+	ImgPtr get_img() const { return state().graphics->get_img(core->graphics[row]); }
+
+	bool is_movement_blocker() const { return state().physics.is_movement_blocker(); }
+	bool can_be_captured() const { return state().can_be_captured(); }
+	bool can_capture() const { return state().can_capture(); }
+
+	Cell current_cell() const { return core->current_cell(row); }
+
+private:
+	std::unique_ptr<SimCore> own_core;   // set while not bound to a game's core
+	SimCore* core;
+	uint32_t row{0};
+};
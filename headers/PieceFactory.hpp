@@ -15,6 +15,7 @@ namespace fs = std::filesystem;
 #include <sstream>
 #include <unordered_set>
 #include <vector>
+#include <algorithm>
 
 #include "Moves.hpp"
 #include "Board.hpp"
@@ -27,9 +28,11 @@ public:
                  const GraphicsFactory& gfx_factory)
         : board(board), pieces_root(pieces_root), gfx_factory(gfx_factory) {}
 
-    // Create pieces from board.csv file
-    std::vector<PiecePtr> create_pieces_from_board_csv(const std::string& board_csv_path) {
-        std::vector<PiecePtr> pieces;
+    using Placement = std::pair<std::string, std::pair<int,int>>;   // piece type, cell
+
+    // Non-empty cells of board.csv in row-major order
+    static std::vector<Placement> read_board_csv(const std::string& board_csv_path) {
+        std::vector<Placement> placements;
         std::ifstream file(board_csv_path);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open board.csv file: " + board_csv_path);
@@ -49,43 +52,67 @@ public:
                 
                 // Skip empty cells
                 if (!cell_value.empty() && cell_value != "0") {
-                    // Check if piece type directory exists
-                    fs::path piece_dir = fs::path(pieces_root) / cell_value;
-                    if (fs::exists(piece_dir) && fs::is_directory(piece_dir)) {
-                        auto piece = create_piece(cell_value, {row, col});
-                        pieces.push_back(piece);
-                    }
+                    placements.push_back({cell_value, {row, col}});
                 }
                 col++;
             }
             row++;
         }
+        return placements;
+    }
+
+    // Create pieces from board.csv file
+    std::vector<PiecePtr> create_pieces_from_board_csv(const std::string& board_csv_path) {
+        return create_pieces(read_board_csv(board_csv_path));
+    }
+
+    std::vector<PiecePtr> create_pieces(const std::vector<Placement>& placements) {
+        std::vector<PiecePtr> pieces;
+        for (const auto& [type_name, cell] : placements) {
+            // Check if piece type directory exists (or the type came from a bundle)
+            fs::path piece_dir = fs::path(pieces_root) / type_name;
+            if (templates.count(type_name) || (fs::exists(piece_dir) && fs::is_directory(piece_dir))) {
+                pieces.push_back(create_piece(type_name, cell));
+            }
+        }
         return pieces;
     }
 
+    const std::string& root() const { return pieces_root; }
+
     // Direct translation of PieceFactory.create_piece from Python
     PiecePtr create_piece(const std::string& type_name,
                           const std::pair<int,int>& cell) {
-        fs::path piece_dir = fs::path(pieces_root) / type_name;
-        auto idle_state = build_state_machine(piece_dir);
-        if(!idle_state) {
-            throw std::runtime_error("Failed to build state machine for piece type: " + type_name);
-        }
+        auto tmpl = get_template(type_name);
 
         // Mimic Python id format: <type>_(r,c)
         std::string id = type_name + "_(" + std::to_string(cell.first) + "," + std::to_string(cell.second) + ")";
 
-        auto piece = std::make_shared<Piece>(id, idle_state);
+        auto piece = std::make_shared<Piece>(id, tmpl);
         // FORCE correct position directly in physics
-        piece->state->physics->start_cell = cell;
-        piece->state->physics->end_cell = cell;
-        piece->state->physics->curr_pos_m = board.cell_to_m(cell);
-        
+        piece->place_at(cell);
+
         return piece;
     }
 
-private:
+    // Use a prebuilt state graph for a piece type (e.g. from an AssetBundle).
+    void register_template(const std::string& type_name, PieceTemplatePtr tmpl) {
+        templates[type_name] = tmpl;
+    }
+
+    // Shared state graph for a piece type, built on first use.
+    PieceTemplatePtr get_template(const std::string& type_name) {
+        auto it = templates.find(type_name);
+        if(it != templates.end()) return it->second;
+
+        fs::path piece_dir = fs::path(pieces_root) / type_name;
+        auto tmpl = build_template(type_name, piece_dir);
+        templates[type_name] = tmpl;
+        return tmpl;
+    }
+
     // ────────────────────────────────────────────────────────────────────
+    // from_state -> event -> to_state, as listed in transitions.csv
     using GlobalTrans = std::unordered_map<std::string, std::unordered_map<std::string, std::string>>;
 
     static GlobalTrans load_master_csv(const fs::path& states_root) {
@@ -107,7 +134,30 @@ private:
         return out;
     }
 
-    std::shared_ptr<State> build_state_machine(const fs::path& piece_dir) {
+    // Resolve transitions by state name, intern their events and compile
+    // them into the template's [state][event] table; locate the idle state.
+    static void link_states(PieceTemplate& tmpl, const GlobalTrans& global_trans, const std::string& origin) {
+        std::vector<PieceTemplate::Transition> compiled;
+        for(const auto& [frm, ev_map] : global_trans) {
+            int src_id = tmpl.find_state(frm);
+            if(src_id < 0) continue;
+            for(const auto& [ev, nxt] : ev_map) {
+                int dst_id = tmpl.find_state(nxt);
+                if(dst_id < 0) continue;
+                compiled.push_back({src_id, Events::intern(ev), dst_id});
+            }
+        }
+        tmpl.compile_transitions(compiled);
+
+        // ensure idle exists
+        tmpl.idle_id = tmpl.find_state("idle");
+        if(tmpl.idle_id < 0) {
+            throw std::runtime_error("State machine missing 'idle' state in " + origin);
+        }
+    }
+
+private:
+    PieceTemplatePtr build_template(const std::string& type_name, const fs::path& piece_dir) {
         fs::path states_root = piece_dir / "states";
         if(!fs::exists(states_root) || !fs::is_directory(states_root)) {
             throw std::runtime_error("Missing states directory: " + states_root.string());
@@ -115,16 +165,23 @@ private:
 
         GlobalTrans global_trans = load_master_csv(states_root);
 
-        std::unordered_map<std::string, std::shared_ptr<State>> states;
+        auto tmpl = std::make_shared<PieceTemplate>();
+        tmpl->type = type_name;
 
         std::pair<int,int> board_size = {board.W_cells, board.H_cells};
         std::pair<int,int> cell_px    = {board.cell_W_pix, board.cell_H_pix};
 
-        // iterate over each subdirectory in states_root
+        // Sorted so that state ids are stable across platforms
+        std::vector<fs::path> state_dirs;
         for(const auto& entry : fs::directory_iterator(states_root)) {
-            if(!entry.is_directory()) continue;
-            std::string name = entry.path().filename().string();
-            fs::path cfg_path = entry.path() / "config.json";
+            if(entry.is_directory()) state_dirs.push_back(entry.path());
+        }
+        std::sort(state_dirs.begin(), state_dirs.end());
+
+        PhysicsFactory phys_factory(board);
+        for(const auto& state_dir : state_dirs) {
+            std::string name = state_dir.filename().string();
+            fs::path cfg_path = state_dir / "config.json";
             nlohmann::json cfg;
             if(fs::exists(cfg_path)) {
                 std::ifstream f(cfg_path);
@@ -136,7 +193,7 @@ private:
             }
 
             // Moves
-            fs::path moves_path = entry.path() / "moves.txt";
+            fs::path moves_path = state_dir / "moves.txt";
             std::shared_ptr<Moves> moves_ptr;
             if(fs::exists(moves_path)) {
                 moves_ptr = std::make_shared<Moves>(moves_path.string(), board_size);
@@ -144,41 +201,24 @@ private:
 
             // Graphics
             nlohmann::json gfx_cfg = cfg.contains("graphics") ? cfg["graphics"] : nlohmann::json{};
-            auto graphics = gfx_factory.load((entry.path()/"sprites").string(), gfx_cfg, cell_px);
+            auto graphics = gfx_factory.load((state_dir/"sprites").string(), gfx_cfg, cell_px);
 
             // Physics
             nlohmann::json phys_cfg = cfg.contains("physics") ? cfg["physics"] : nlohmann::json{};
-            PhysicsFactory phys_factory(board);
             auto physics = phys_factory.create({0,0}, name, phys_cfg);
             // Note: need_clear_path flag not implemented in C++ physics yet
 
-            auto st = std::make_shared<State>(moves_ptr, graphics, physics);
-            st->name = name;
-            states[name] = st;
-        }
-
-        // apply global transitions overrides
-        for(const auto& [frm, ev_map] : global_trans) {
-            auto src_it = states.find(frm);
-            if(src_it == states.end()) continue;
-            auto src = src_it->second;
-            for(const auto& [ev, nxt] : ev_map) {
-                auto dst_it = states.find(nxt);
-                if(dst_it == states.end()) continue;
-                src->set_transition(ev, dst_it->second);
-            }
+            int id = static_cast<int>(tmpl->states.size());
+            tmpl->states.emplace_back(id, name, moves_ptr, graphics, physics);
         }
 
-        // ensure idle exists
-        auto idle_it = states.find("idle");
-        if(idle_it == states.end()) {
-            throw std::runtime_error("State machine missing 'idle' state in " + piece_dir.string());
-        }
-        return idle_it->second;
+        link_states(*tmpl, global_trans, piece_dir.string());
+        return tmpl;
     }
 
 private:
     Board& board;
     std::string pieces_root;
     const GraphicsFactory& gfx_factory;
+    std::unordered_map<std::string, PieceTemplatePtr> templates;
 };
\ No newline at end of file
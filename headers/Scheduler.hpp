@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SlotMap.hpp"
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// DeadlineScheduler – min-heap of piece wake-up times, keyed by slot handle.
+// Each slot has at most one live deadline; re-arming or cancelling leaves the
+// old heap entry behind and it is skipped when it surfaces. Idle pieces are
+// simply never armed, so a tick only costs as much as the pieces that are
+// actually due.
+// ---------------------------------------------------------------------------
+class DeadlineScheduler {
+public:
+    // Arm (or re-arm) a piece to wake at deadline_ms
+    void schedule(SlotHandle piece, int deadline_ms) {
+        uint64_t seq = ++next_seq;
+        if(armed.size() <= piece.index()) armed.resize(piece.index() + 1, 0);
+        if(armed[piece.index()] == 0) ++live;
+        armed[piece.index()] = seq;
+        heap.push({deadline_ms, seq, piece});
+    }
+
+    void cancel(SlotHandle piece) {
+        if(piece.index() < armed.size() && armed[piece.index()] != 0) {
+            armed[piece.index()] = 0;
+            --live;
+        }
+    }
+
+    // Append every piece due at or before now_ms to out, earliest first (ties
+    // in arming order), and disarm them.
+    void pop_due(int now_ms, std::vector<SlotHandle>& out) {
+        while(!heap.empty() && heap.top().deadline_ms <= now_ms) {
+            Entry e = heap.top();
+            heap.pop();
+            if(armed[e.piece.index()] != e.seq) continue;   // stale
+            armed[e.piece.index()] = 0;
+            --live;
+            out.push_back(e.piece);
+        }
+    }
+
+    size_t pending() const { return live; }
+
+    void clear() {
+        heap = {};
+        armed.clear();
+        live = 0;
+    }
+
+private:
+    struct Entry {
+        int deadline_ms;
+        uint64_t seq;
+        SlotHandle piece;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.deadline_ms != b.deadline_ms ? a.deadline_ms > b.deadline_ms : a.seq > b.seq;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> heap;
+    std::vector<uint64_t> armed;   // slot index -> seq of its live entry (0: none)
+    size_t live{0};
+    uint64_t next_seq{0};
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "State.hpp"
+#include "Command.hpp"
+#include "MoveIntegrator.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// SimCore – simulation state of a set of pieces as parallel arrays, one row
+// per piece. A tick walks these columns directly (template, state id, physics
+// kind, physics fields) instead of going through each Piece; Piece is a thin
+// facade over its row. Game keeps one core with row == slot index in
+// Game::pieces; a piece outside any game owns a private one-row core.
+// ---------------------------------------------------------------------------
+class SimCore {
+public:
+    using Cell = std::pair<int,int>;
+
+    // --- columns ---
+    std::vector<const PieceTemplate*> tmpl;   // kept alive by the Piece
+    std::vector<int> state_id;
+    std::vector<PhysicsKind> kind;            // kind of the current state's physics
+    PhysicsColumns physics;
+    std::vector<GraphicsRuntime> graphics;    // only touched on transitions and when drawn
+    MoveIntegrator moves;                     // every row whose kind is Move
+
+    size_t rows() const { return state_id.size(); }
+    void resize(size_t rows);
+    void copy_row(const SimCore& from, uint32_t src, uint32_t dst);
+
+    // Make `row` a piece of type t sitting idle
+    void init_row(uint32_t row, const PieceTemplate& t);
+
+    const StateTemplate& state(uint32_t row) const { return tmpl[row]->state(state_id[row]); }
+
+    void enter(uint32_t row, int next_state, const CompactCommand& cmd);
+    // Follow the transition for cmd.event, if the current state has one
+    void transition(uint32_t row, const CompactCommand& cmd);
+
+    // Advance one row to now_ms. Returns true if the row changed cell or
+    // state, i.e. whenever the game's occupancy view of it may be stale.
+    bool update(uint32_t row, int now_ms);
+
+    // Sort rows by physics kind, then row, for update_rows
+    void group_by_kind(uint32_t* rows, size_t n) const;
+
+    // Advance rows[0..n) to now_ms, setting changed[row] to whether each one
+    // changed. Each run of rows with the same physics kind is one loop over
+    // that concrete kind, so group_by_kind first. Rows only touch their own
+    // entries, so disjoint ranges may run on different threads.
+    void update_rows(const uint32_t* rows, size_t n, int now_ms, uint8_t* changed);
+
+    // Advance every moving row to now_ms in one batch (see MoveIntegrator),
+    // firing "done" for the ones that arrived, and append the rows that
+    // changed cell or state to `changed`.
+    void advance_moves(int now_ms, std::vector<uint32_t>& changed);
+
+    // The row no longer holds a piece (e.g. it was captured)
+    void release_row(uint32_t row) { moves.remove(row); }
+
+    Cell current_cell(uint32_t row) const;
+    int next_deadline_ms(uint32_t row, int now_ms) const {
+        return state(row).physics.next_deadline_ms(physics, row, now_ms);
+    }
+
+private:
+    template <typename P> bool update_as(uint32_t row, int now_ms);
+    template <typename P> void update_run(const uint32_t* rows, size_t n, int now_ms, uint8_t* changed);
+    Cell cell_of(const BasePhysics& ph, uint32_t row) const;
+    void track_move(uint32_t row);
+
+    std::vector<MoveIntegrator::Event> move_events_;   // reused by advance_moves
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 32-bit handle into a SlotMap: 20 bits of slot index, 12 bits of generation.
+// A slot's generation is bumped every time it is freed, so handles to a
+// removed element stop resolving (until the generation wraps after 4096
+// reuses of the same slot).
+struct SlotHandle {
+    static constexpr uint32_t kIndexBits = 20;
+    static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static constexpr uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+    static constexpr uint32_t kMaxSlots = kIndexMask;   // all-ones index is reserved
+
+    uint32_t bits{0xFFFFFFFFu};
+
+    SlotHandle() = default;
+    SlotHandle(uint32_t index, uint32_t generation)
+        : bits(((generation & kGenerationMask) << kIndexBits) | (index & kIndexMask)) {}
+
+    uint32_t index() const { return bits & kIndexMask; }
+    uint32_t generation() const { return bits >> kIndexBits; }
+    bool valid() const { return bits != 0xFFFFFFFFu; }
+
+    bool operator==(const SlotHandle& o) const { return bits == o.bits; }
+    bool operator!=(const SlotHandle& o) const { return bits != o.bits; }
+};
+
+// ---------------------------------------------------------------------------
+// SlotMap – values in stable slots addressed by SlotHandle. insert reuses a
+// freed slot when there is one, remove is O(1) and never moves other values,
+// and iteration walks the slot array skipping dead slots.
+// ---------------------------------------------------------------------------
+template <typename T>
+class SlotMap {
+    struct Slot {
+        T value{};
+        uint32_t generation{0};
+        bool alive{false};
+    };
+
+public:
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if(!free_slots.empty()) {
+            index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        Slot& s = slots[index];
+        s.value = std::move(value);
+        s.alive = true;
+        ++live;
+        return SlotHandle(index, s.generation);
+    }
+
+    // False if the handle was already stale
+    bool remove(SlotHandle h) {
+        if(!contains(h)) return false;
+        Slot& s = slots[h.index()];
+        s.value = T{};
+        s.alive = false;
+        s.generation = (s.generation + 1) & SlotHandle::kGenerationMask;
+        free_slots.push_back(h.index());
+        --live;
+        return true;
+    }
+
+    bool contains(SlotHandle h) const {
+        return h.valid() && h.index() < slots.size() && slots[h.index()].alive
+            && slots[h.index()].generation == h.generation();
+    }
+
+    T* get(SlotHandle h) { return contains(h) ? &slots[h.index()].value : nullptr; }
+    const T* get(SlotHandle h) const { return contains(h) ? &slots[h.index()].value : nullptr; }
+
+    // Handle of the live value in slot `index`, invalid if the slot is free
+    SlotHandle handle_at(uint32_t index) const {
+        return index < slots.size() && slots[index].alive ? SlotHandle(index, slots[index].generation) : SlotHandle();
+    }
+
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+    // Number of slots (live or free); slot indices are below this
+    size_t slot_count() const { return slots.size(); }
+
+    template <typename SlotVec, typename V>
+    class basic_iterator {
+    public:
+        basic_iterator(SlotVec* s, size_t i) : slots_(s), i_(i) { skip(); }
+        V& operator*() const { return (*slots_)[i_].value; }
+        V* operator->() const { return &(*slots_)[i_].value; }
+        basic_iterator& operator++() { ++i_; skip(); return *this; }
+        bool operator!=(const basic_iterator& o) const { return i_ != o.i_; }
+        bool operator==(const basic_iterator& o) const { return i_ == o.i_; }
+        SlotHandle handle() const { return SlotHandle(static_cast<uint32_t>(i_), (*slots_)[i_].generation); }
+    private:
+        void skip() { while(i_ < slots_->size() && !(*slots_)[i_].alive) ++i_; }
+        SlotVec* slots_;
+        size_t i_;
+    };
+    using iterator = basic_iterator<std::vector<Slot>, T>;
+    using const_iterator = basic_iterator<const std::vector<Slot>, const T>;
+
+    iterator begin() { return iterator(&slots, 0); }
+    iterator end() { return iterator(&slots, slots.size()); }
+    const_iterator begin() const { return const_iterator(&slots, 0); }
+    const_iterator end() const { return const_iterator(&slots, slots.size()); }
+
+private:
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    size_t live{0};
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "img/ImgFactory.hpp"
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// SpriteAtlas – packs many small images into one contiguous canvas (shelf
+// packing, tallest first) and hands back sub-rectangle views into it. The
+// views share the atlas buffer, so every frame lives in one allocation with
+// good locality for draw_on.
+// ---------------------------------------------------------------------------
+class SpriteAtlas {
+public:
+    struct Rect { int x; int y; int w; int h; };
+
+    // Views are returned in the order of `images`; entries that could not be
+    // packed (null images, factories without pixel views) are returned as-is.
+    static SpriteAtlas pack(const std::vector<ImgPtr>& images, const ImgFactoryPtr& img_factory);
+
+    ImgPtr atlas;                 // the shared canvas (nullptr if nothing packed)
+    std::vector<ImgPtr> views;
+    std::vector<Rect> rects;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "img/ImgFactory.hpp"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Immutable, shareable list of decoded animation frames.
+using FrameSet = std::vector<ImgPtr>;
+using FrameSetPtr = std::shared_ptr<const FrameSet>;
+
+// ---------------------------------------------------------------------------
+// SpriteCache – process-wide cache of decoded sprites keyed by canonical path,
+// target size and the concrete ImgFactory type that decoded them (a Mock
+// image is never handed to an OpenCV consumer). Every Graphics built for the
+// same piece type and state shares one FrameSet instead of decoding its own
+// copy of the PNGs.
+// ---------------------------------------------------------------------------
+class SpriteCache {
+public:
+    static SpriteCache& instance();
+
+    // All *.png files of sprites_folder, decoded and resized, in numeric order
+    // (1.png, 2.png, ...). Missing folders yield an empty FrameSet.
+    FrameSetPtr load_frames(const std::string& sprites_folder,
+                            std::pair<int,int> size,
+                            const ImgFactoryPtr& img_factory);
+
+    // Same, for a frame list produced earlier by list_frames (no filesystem
+    // access when the images are already cached).
+    FrameSetPtr load_frames(const std::string& sprites_folder,
+                            const std::vector<std::string>& frame_paths,
+                            std::pair<int,int> size,
+                            const ImgFactoryPtr& img_factory);
+
+    // Paths of the *.png files of sprites_folder in numeric order.
+    static std::vector<std::string> list_frames(const std::string& sprites_folder);
+
+    // Single decoded image; nullptr if the factory could not produce one.
+    ImgPtr load(const std::string& path,
+                std::pair<int,int> size,
+                const ImgFactoryPtr& img_factory);
+
+    // Lazily decoded frame sets, kept in a bounded LRU instead of the
+    // permanent maps above. `folder` must come from canonical_path(); the
+    // frames are decoded on the first call and evicted least recently used
+    // first once more than lru_capacity() sets are resident.
+    FrameSetPtr acquire_lru(const std::string& folder,
+                            const std::vector<std::string>& frame_paths,
+                            std::pair<int,int> size,
+                            const ImgFactoryPtr& img_factory);
+
+    void set_lru_capacity(size_t frame_sets);
+    size_t lru_capacity() const;
+    size_t lru_size() const;
+
+    static std::string canonical_path(const std::string& path);
+
+    // Repack every cached image decoded by img_factory's type into one
+    // SpriteAtlas. Those images and the frame sets holding them become
+    // sub-rectangle views of it; Graphics built afterwards share the single
+    // buffer. Does nothing unless images were added since the last call.
+    // Returns the number of images packed.
+    size_t build_atlas(const ImgFactoryPtr& img_factory);
+    ImgPtr atlas() const;
+
+    void clear();
+    size_t image_count() const;
+
+private:
+    SpriteCache() = default;
+
+    struct Key {
+        std::string path;
+        int w;
+        int h;
+        std::type_index factory;   // dynamic type of the decoding ImgFactory
+        bool operator==(const Key& o) const {
+            return w == o.w && h == o.h && factory == o.factory && path == o.path;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const noexcept {
+            return std::hash<std::string>{}(k.path) ^ (static_cast<size_t>(k.w) * 31u + static_cast<size_t>(k.h))
+                 ^ (k.factory.hash_code() << 1);
+        }
+    };
+
+    static std::type_index factory_type(const ImgFactoryPtr& img_factory);
+    static Key make_key(const std::string& path, std::pair<int,int> size, const ImgFactoryPtr& img_factory);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, ImgPtr, KeyHash> images_;
+    std::unordered_map<Key, FrameSetPtr, KeyHash> frame_sets_;
+    ImgPtr atlas_;
+    bool atlas_stale_{false};   // images_ has entries the atlas does not cover
+
+    using LruList = std::list<std::pair<Key, FrameSetPtr>>;   // most recent first
+    LruList lru_;
+    std::unordered_map<Key, LruList::iterator, KeyHash> lru_index_;
+    size_t lru_capacity_{32};
+};
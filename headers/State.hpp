@@ -3,56 +3,78 @@
 #include "Moves.hpp"
 #include "Graphics.hpp"
 #include "Physics.hpp"
+#include "Event.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
 #include <string>
-#include <cctype>
+#include <vector>
+#include <stdexcept>
 
-class State : public std::enable_shared_from_this<State> {
+// ---------------------------------------------------------------------------
+// StateTemplate – immutable description of one state of a piece type. It is
+// shared by every piece of that type; per-piece data lives in SimCore.
+// ---------------------------------------------------------------------------
+class StateTemplate {
 public:
-    State(std::shared_ptr<Moves> moves,
-          std::shared_ptr<Graphics> graphics,
-          std::shared_ptr<BasePhysics> physics)
-        : moves(moves), graphics(graphics), physics(physics) {}
+    StateTemplate(int id,
+                  std::string name,
+                  std::shared_ptr<const Moves> moves,
+                  std::shared_ptr<const Graphics> graphics,
+                  Physics physics)
+        : id(id), name(std::move(name)), moves(moves), graphics(graphics), physics(std::move(physics)) {}
 
-    std::shared_ptr<Moves>    moves;
-    std::shared_ptr<Graphics> graphics;
-    std::shared_ptr<BasePhysics> physics;
-
-    // Keep strong references so target states are not destroyed while only reachable via this map
-    std::unordered_map<std::string, std::shared_ptr<State>> transitions;
+    int id;
     std::string name;
+    std::shared_ptr<const Moves>       moves;
+    std::shared_ptr<const Graphics>    graphics;
+    Physics physics;
+
+    bool can_be_captured() const { return physics.can_be_captured(); }
+    bool can_capture()    const { return physics.can_capture(); }
+};
+
+// ---------------------------------------------------------------------------
+// PieceTemplate – the complete state graph of one piece type, built once by
+// PieceFactory and shared by all its pieces.
+// ---------------------------------------------------------------------------
+class PieceTemplate {
+public:
+    std::string type;
+    std::vector<StateTemplate> states;   // indexed by StateTemplate::id
+    int idle_id{-1};
+
+    // Compiled transitions: target state of [state][event], -1 if none. Rows
+    // are event_stride wide; events interned after compiling have no entry.
+    std::vector<int16_t> transition_table;
+    int event_stride{0};
 
-    void set_transition(const std::string& event, const std::shared_ptr<State>& target) { transitions[event] = target; }
+    const StateTemplate& state(int id) const { return states[static_cast<size_t>(id)]; }
 
-    void reset(const Command& cmd) {
-        physics->reset(cmd);
-        graphics->reset(cmd);
+    // Target state id for an event, or -1 if none
+    int next_state(int state_id, EventId event) const {
+        if(event < 0 || event >= event_stride) return -1;
+        return transition_table[static_cast<size_t>(state_id) * event_stride + event];
     }
 
-    std::shared_ptr<State> on_command(const Command& cmd) {
-        std::string key = cmd.type;
-        for(auto& ch : key) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-        auto it = transitions.find(key);
-        if(it != transitions.end()) {
-            auto next = it->second;
-            if(next) {
-                next->reset(cmd);
-                return next;
-            }
+    // Build transition_table from (from_state, event, to_state) triples
+    struct Transition { int from; EventId event; int to; };
+    void compile_transitions(const std::vector<Transition>& transitions) {
+        event_stride = 0;
+        for(const auto& t : transitions) event_stride = std::max(event_stride, t.event + 1);
+        transition_table.assign(states.size() * static_cast<size_t>(event_stride), -1);
+        for(const auto& t : transitions) {
+            transition_table[static_cast<size_t>(t.from) * event_stride + t.event] = static_cast<int16_t>(t.to);
         }
-        return shared_from_this();
     }
 
-    std::shared_ptr<State> update(int now_ms) {
-        auto internal = physics->update(now_ms);
-        if(internal) {
-            return on_command(*internal);
+    int find_state(const std::string& name) const {
+        for(const auto& st : states) {
+            if(st.name == name) return st.id;
         }
-        graphics->update(now_ms); // keep graphics in sync when no state change
-        return shared_from_this();
+        return -1;
     }
+};
+typedef std::shared_ptr<const PieceTemplate> PieceTemplatePtr;
 
-    bool can_be_captured() const { return physics->can_be_captured(); }
-    bool can_capture()    const { return physics->can_capture(); }
-};
\ No newline at end of file
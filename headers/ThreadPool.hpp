@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ThreadPool – fixed set of workers, each with its own task deque. A worker
+// pops its newest task first and, when it runs dry, steals the oldest task of
+// another worker. Tasks submitted from a worker stay on that worker's deque;
+// tasks from other threads are spread round-robin.
+// ---------------------------------------------------------------------------
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(unsigned threads = 0);
+    // Runs every queued task, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    void submit(Task task);
+
+    // Run fn(0) .. fn(n-1) on the pool and return once all have finished,
+    // rethrowing the first exception. The calling thread runs tasks while it
+    // waits, so this is safe from inside a task too.
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(size_t self);
+    bool run_one(size_t self);   // self == size() for threads outside the pool
+    size_t current_worker() const;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+    std::atomic<size_t> pending{0};     // queued, not yet started
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping{false};               // guarded by sleep_mutex
+};
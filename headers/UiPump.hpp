@@ -0,0 +1,56 @@
+#pragma once
+
+#include "img/Img.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// ---------------------------------------------------------------------------
+// UiPump – the one thread that talks to HighGUI. It owns the window, is the
+// only caller of cv::waitKey, forwards every key to on_key stamped with the
+// time it was read, and shows the newest frame handed to present(). Frames
+// not yet shown are replaced, never queued.
+//
+// present() may carry the timestamp of the oldest input the frame reflects;
+// the delay until that frame is on screen is the input-to-display latency.
+// ---------------------------------------------------------------------------
+class UiPump {
+public:
+    using KeyHandler = std::function<void(int key, int timestamp_ms)>;
+    using TimeSource = std::function<int()>;
+
+    struct LatencyStats {
+        int samples{0};
+        double mean_ms{0.0};
+        int max_ms{0};
+    };
+
+    UiPump(KeyHandler on_key, TimeSource now_ms);
+    ~UiPump();
+
+    void start();
+    // Stop pumping, close the window and join the thread
+    void stop();
+
+    // Any thread. input_ms < 0: the frame reflects no new input.
+    void present(ImgPtr frame, int input_ms = -1);
+
+    LatencyStats latency() const;
+
+private:
+    void loop();
+
+    KeyHandler on_key;
+    TimeSource now_ms;
+
+    mutable std::mutex mutex_;      // guards the mailbox and the stats
+    ImgPtr pending_frame;
+    int pending_input_ms{-1};
+    int samples{0};
+    long long total_latency_ms{0};
+    int max_latency_ms{0};
+
+    std::atomic<bool> running_{false};
+    std::thread worker_;
+};
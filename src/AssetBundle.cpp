@@ -0,0 +1,470 @@
+#include "../headers/AssetBundle.hpp"
+#include "../headers/PhysicsFactory.hpp"
+#include "../headers/SpriteCache.hpp"
+#include "../headers/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char kMagic[4] = {'K', 'F', 'C', 'B'};
+constexpr uint64_t kAlign = 64;
+constexpr size_t kHeaderSize = 4 + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+uint64_t align_up(uint64_t v) { return (v + kAlign - 1) & ~(kAlign - 1); }
+
+// Append-only little helper for the meta section
+class ByteWriter {
+public:
+    template <typename T>
+    void put(T v) {
+        const char* p = reinterpret_cast<const char*>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+    void put_str(const std::string& s) {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        bytes.insert(bytes.end(), s.begin(), s.end());
+    }
+    std::vector<char> bytes;
+};
+
+// Bounds-checked reader over the mapped meta section
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : p(data), end(data + size) {}
+
+    template <typename T>
+    T get() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    std::string get_str() {
+        uint32_t n = get<uint32_t>();
+        need(n);
+        std::string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+
+private:
+    void need(size_t n) const {
+        if(static_cast<size_t>(end - p) < n) throw std::runtime_error("Truncated asset bundle");
+    }
+    const uint8_t* p;
+    const uint8_t* end;
+};
+
+// Pixel blobs collected while packing, laid out in write order
+struct PixelSection {
+    AssetBundle::Frame add(const ImgPtr& img) {
+        AssetBundle::Frame frame;
+        if(!img) return frame;
+        std::vector<uint8_t> px;
+        int channels = 0;
+        auto size = img->size();
+        frame.w = size.first;
+        frame.h = size.second;
+        if(!img->copy_pixels(px, channels)) return frame;   // e.g. MockImg
+        frame.channels = channels;
+        frame.offset = total;
+        total = align_up(total + px.size());
+        blobs.push_back(std::move(px));
+        return frame;
+    }
+    std::vector<std::vector<uint8_t>> blobs;
+    uint64_t total{0};
+};
+
+void put_frame(ByteWriter& w, const AssetBundle::Frame& f) {
+    w.put<int32_t>(f.w);
+    w.put<int32_t>(f.h);
+    w.put<int32_t>(f.channels);
+    w.put<uint64_t>(f.offset);
+}
+
+AssetBundle::Frame get_frame(ByteReader& r) {
+    AssetBundle::Frame f;
+    f.w = r.get<int32_t>();
+    f.h = r.get<int32_t>();
+    f.channels = r.get<int32_t>();
+    f.offset = r.get<uint64_t>();
+    return f;
+}
+
+void put_params(ByteWriter& w, const nlohmann::json& section) {
+    std::vector<AssetBundle::Param> params;
+    if(section.is_object()) {
+        for(auto it = section.begin(); it != section.end(); ++it) {
+            if(it.value().is_boolean()) params.push_back({it.key(), it.value().get<bool>() ? 1.0 : 0.0, true});
+            else if(it.value().is_number()) params.push_back({it.key(), it.value().get<double>(), false});
+        }
+    }
+    w.put<uint32_t>(static_cast<uint32_t>(params.size()));
+    for(const auto& p : params) {
+        w.put_str(p.key);
+        w.put<double>(p.value);
+        w.put<uint8_t>(p.is_bool ? 1 : 0);
+    }
+}
+
+std::vector<AssetBundle::Param> get_params(ByteReader& r) {
+    std::vector<AssetBundle::Param> params(r.get<uint32_t>());
+    for(auto& p : params) {
+        p.key = r.get_str();
+        p.value = r.get<double>();
+        p.is_bool = r.get<uint8_t>() != 0;
+    }
+    return params;
+}
+
+// Rebuild the config section without going through the JSON parser
+nlohmann::json to_json(const std::vector<AssetBundle::Param>& params) {
+    nlohmann::json out = nlohmann::json::object();
+    for(const auto& p : params) {
+        if(p.is_bool) out[p.key] = p.value != 0.0;
+        else out[p.key] = p.value;
+    }
+    return out;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Read-only view of the whole file (copy-on-write, so OpenCV never faults if
+// something writes into a sprite).
+// ---------------------------------------------------------------------------
+struct AssetBundle::Mapping {
+    const uint8_t* data{nullptr};
+    size_t size{0};
+#ifdef _WIN32
+    HANDLE file{INVALID_HANDLE_VALUE};
+    HANDLE map{nullptr};
+#endif
+
+    explicit Mapping(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open asset bundle: " + path);
+        LARGE_INTEGER li;
+        GetFileSizeEx(file, &li);
+        size = static_cast<size_t>(li.QuadPart);
+        map = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if(map) data = static_cast<const uint8_t*>(MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0));
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("Cannot open asset bundle: " + path);
+        struct stat st;
+        if(::fstat(fd, &st) == 0) size = static_cast<size_t>(st.st_size);
+        if(size > 0) {
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED) data = static_cast<const uint8_t*>(p);
+        }
+        ::close(fd);
+#endif
+        if(!data) {
+            release();
+            throw std::runtime_error("Cannot map asset bundle: " + path);
+        }
+    }
+
+    ~Mapping() { release(); }
+
+    void release() {
+#ifdef _WIN32
+        if(data) UnmapViewOfFile(data);
+        if(map) CloseHandle(map);
+        if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        map = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if(data) ::munmap(const_cast<uint8_t*>(data), size);
+#endif
+        data = nullptr;
+    }
+};
+
+// ---------------------------------------------------------------------------
+void AssetBundle::pack(const std::string& pieces_root,
+                       const std::string& out_path,
+                       const ImgFactoryPtr& img_factory,
+                       std::pair<int,int> cell_size,
+                       std::pair<int,int> board_cells) {
+    fs::path root(pieces_root);
+    ByteWriter meta;
+    PixelSection pixels;
+
+    meta.put<int32_t>(cell_size.first);
+    meta.put<int32_t>(cell_size.second);
+    meta.put<int32_t>(board_cells.first);
+    meta.put<int32_t>(board_cells.second);
+
+    // Board image, pre-resized to the full board
+    std::pair<int,int> board_px = {cell_size.first * board_cells.first, cell_size.second * board_cells.second};
+    put_frame(meta, pixels.add(img_factory->load((root / "board.png").string(), board_px)));
+
+    auto placements = PieceFactory::read_board_csv((root / "board.csv").string());
+    meta.put<uint32_t>(static_cast<uint32_t>(placements.size()));
+    for(const auto& [type_name, cell] : placements) {
+        meta.put_str(type_name);
+        meta.put<int32_t>(cell.first);
+        meta.put<int32_t>(cell.second);
+    }
+
+    std::vector<fs::path> type_dirs;
+    for(const auto& entry : fs::directory_iterator(root)) {
+        if(entry.is_directory() && fs::is_directory(entry.path() / "states")) type_dirs.push_back(entry.path());
+    }
+    std::sort(type_dirs.begin(), type_dirs.end());
+
+    meta.put<uint32_t>(static_cast<uint32_t>(type_dirs.size()));
+    size_t frame_count = 0;
+    for(const auto& type_dir : type_dirs) {
+        fs::path states_root = type_dir / "states";
+        meta.put_str(type_dir.filename().string());
+
+        std::vector<fs::path> state_dirs;
+        for(const auto& entry : fs::directory_iterator(states_root)) {
+            if(entry.is_directory()) state_dirs.push_back(entry.path());
+        }
+        std::sort(state_dirs.begin(), state_dirs.end());
+
+        meta.put<uint32_t>(static_cast<uint32_t>(state_dirs.size()));
+        for(const auto& state_dir : state_dirs) {
+            meta.put_str(state_dir.filename().string());
+
+            nlohmann::json cfg;
+            fs::path cfg_path = state_dir / "config.json";
+            if(fs::exists(cfg_path)) {
+                std::ifstream f(cfg_path);
+                try {
+                    f >> cfg;
+                } catch(const std::exception&) {
+                    // ignore invalid json – default cfg
+                }
+            }
+            put_params(meta, cfg.contains("physics") ? cfg["physics"] : nlohmann::json{});
+            put_params(meta, cfg.contains("graphics") ? cfg["graphics"] : nlohmann::json{});
+
+            fs::path moves_path = state_dir / "moves.txt";
+            bool has_moves = fs::exists(moves_path);
+            meta.put<uint8_t>(has_moves ? 1 : 0);
+            std::vector<Moves::RelMove> rel;
+            if(has_moves) rel = Moves(moves_path.string(), board_cells).relative_moves();
+            meta.put<uint32_t>(static_cast<uint32_t>(rel.size()));
+            for(const auto& mv : rel) {
+                meta.put<int32_t>(mv.dr);
+                meta.put<int32_t>(mv.dc);
+                meta.put<int32_t>(mv.tag);
+            }
+
+            auto frames = SpriteCache::list_frames((state_dir / "sprites").string());
+            meta.put<uint32_t>(static_cast<uint32_t>(frames.size()));
+            for(const auto& frame_path : frames) {
+                put_frame(meta, pixels.add(img_factory->load(frame_path, cell_size)));
+            }
+            frame_count += frames.size();
+        }
+
+        auto trans = PieceFactory::load_master_csv(states_root);
+        std::vector<Transition> flat;
+        for(const auto& [frm, ev_map] : trans) {
+            for(const auto& [ev, nxt] : ev_map) flat.push_back({frm, ev, nxt});
+        }
+        std::sort(flat.begin(), flat.end(), [](const Transition& a, const Transition& b) {
+            return std::tie(a.from, a.event) < std::tie(b.from, b.event);
+        });
+        meta.put<uint32_t>(static_cast<uint32_t>(flat.size()));
+        for(const auto& t : flat) {
+            meta.put_str(t.from);
+            meta.put_str(t.event);
+            meta.put_str(t.to);
+        }
+    }
+
+    // Header, meta, padding, pixels
+    uint64_t meta_size = meta.bytes.size();
+    uint64_t pixels_offset = align_up(kHeaderSize + meta_size);
+
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    if(!out) throw std::runtime_error("Cannot write asset bundle: " + out_path);
+    out.write(kMagic, sizeof(kMagic));
+    out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+    out.write(reinterpret_cast<const char*>(&meta_size), sizeof(meta_size));
+    out.write(reinterpret_cast<const char*>(&pixels_offset), sizeof(pixels_offset));
+    out.write(meta.bytes.data(), static_cast<std::streamsize>(meta.bytes.size()));
+
+    std::vector<char> pad(kAlign, 0);
+    uint64_t written = kHeaderSize + meta_size;
+    out.write(pad.data(), static_cast<std::streamsize>(pixels_offset - written));
+    written = 0;
+    for(const auto& blob : pixels.blobs) {
+        out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+        uint64_t next = align_up(written + blob.size());
+        out.write(pad.data(), static_cast<std::streamsize>(next - written - blob.size()));
+        written = next;
+    }
+    if(!out) throw std::runtime_error("Failed writing asset bundle: " + out_path);
+
+    KFC_LOG_INFO("Packed %zu piece types, %zu frames (%llu KiB of pixels) into %s",
+                 type_dirs.size(), frame_count, static_cast<unsigned long long>(pixels.total / 1024), out_path.c_str());
+}
+
+// ---------------------------------------------------------------------------
+bool AssetBundle::is_up_to_date(const std::string& bundle_path, const std::string& pieces_root) {
+    std::error_code ec;
+    fs::path bundle(bundle_path);
+    auto bundle_time = fs::last_write_time(bundle, ec);
+    if(ec) return false;
+    for(fs::recursive_directory_iterator it(pieces_root, ec), end; !ec && it != end; it.increment(ec)) {
+        if(!it->is_regular_file(ec) || fs::equivalent(it->path(), bundle, ec)) continue;
+        if(fs::last_write_time(it->path(), ec) > bundle_time) {
+            KFC_LOG_INFO("Asset bundle %s is older than %s", bundle_path.c_str(), it->path().string().c_str());
+            return false;
+        }
+    }
+    return !ec;
+}
+
+std::shared_ptr<const AssetBundle> AssetBundle::open(const std::string& path) {
+    auto bundle = std::make_shared<AssetBundle>();
+    bundle->mapping = std::make_shared<Mapping>(path);
+    const uint8_t* base = bundle->mapping->data;
+    size_t size = bundle->mapping->size;
+
+    if(size < kHeaderSize || std::memcmp(base, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not an asset bundle: " + path);
+    }
+    ByteReader header(base + sizeof(kMagic), kHeaderSize - sizeof(kMagic));
+    uint32_t version = header.get<uint32_t>();
+    uint64_t meta_size = header.get<uint64_t>();
+    uint64_t pixels_offset = header.get<uint64_t>();
+    if(version != kVersion) {
+        throw std::runtime_error("Asset bundle version " + std::to_string(version) +
+                                 " is not supported (expected " + std::to_string(kVersion) + "): " + path);
+    }
+    if(kHeaderSize + meta_size > size || pixels_offset > size) {
+        throw std::runtime_error("Truncated asset bundle: " + path);
+    }
+    bundle->pixels = base + pixels_offset;
+    uint64_t pixels_size = size - pixels_offset;
+
+    // Validate the fields before using them: negative sizes would wrap in
+    // the multiplication and a huge offset would wrap in offset + bytes.
+    auto check = [&](const Frame& f) {
+        bool shape_ok = f.w > 0 && f.h > 0 && (f.channels == 1 || f.channels == 3 || f.channels == 4);
+        uint64_t bytes = shape_ok ? static_cast<uint64_t>(f.w) * static_cast<uint64_t>(f.h) * f.channels : 0;
+        if(!shape_ok || bytes > pixels_size || f.offset > pixels_size - bytes) {
+            throw std::runtime_error("Corrupt frame in asset bundle: " + path);
+        }
+        return f;
+    };
+
+    ByteReader r(base + kHeaderSize, meta_size);
+    bundle->cell_size.first = r.get<int32_t>();
+    bundle->cell_size.second = r.get<int32_t>();
+    bundle->board_cells.first = r.get<int32_t>();
+    bundle->board_cells.second = r.get<int32_t>();
+    bundle->board_image = check(get_frame(r));
+
+    bundle->placements.resize(r.get<uint32_t>());
+    for(auto& placement : bundle->placements) {
+        placement.first = r.get_str();
+        placement.second.first = r.get<int32_t>();
+        placement.second.second = r.get<int32_t>();
+    }
+
+    bundle->types.resize(r.get<uint32_t>());
+    for(auto& type : bundle->types) {
+        type.type = r.get_str();
+        type.states.resize(r.get<uint32_t>());
+        for(auto& st : type.states) {
+            st.name = r.get_str();
+            st.physics_cfg = get_params(r);
+            st.graphics_cfg = get_params(r);
+            st.has_moves = r.get<uint8_t>() != 0;
+            st.moves.resize(r.get<uint32_t>());
+            for(auto& mv : st.moves) {
+                mv.dr = r.get<int32_t>();
+                mv.dc = r.get<int32_t>();
+                mv.tag = r.get<int32_t>();
+            }
+            st.frames.resize(r.get<uint32_t>());
+            for(auto& f : st.frames) f = check(get_frame(r));
+        }
+        type.transitions.resize(r.get<uint32_t>());
+        for(auto& t : type.transitions) {
+            t.from = r.get_str();
+            t.event = r.get_str();
+            t.to = r.get_str();
+        }
+    }
+    return bundle;
+}
+
+// ---------------------------------------------------------------------------
+ImgPtr AssetBundle::image(const Frame& frame, const ImgFactoryPtr& img_factory) const {
+    if(!img_factory) return nullptr;
+    if(frame.channels == 0) return img_factory->create_blank(frame.w, frame.h);   // packed without pixels
+    // The mapping travels with the image so views stay valid after the bundle goes
+    return img_factory->from_pixels(frame.w, frame.h, frame.channels, pixels + frame.offset, mapping);
+}
+
+void AssetBundle::register_templates(PieceFactory& piece_factory,
+                                     const Board& board,
+                                     const GraphicsFactory& gfx_factory,
+                                     const ImgFactoryPtr& img_factory) const {
+    PhysicsFactory phys_factory(board);
+    std::pair<int,int> board_size = {board.W_cells, board.H_cells};
+
+    for(const auto& type : types) {
+        auto tmpl = std::make_shared<PieceTemplate>();
+        tmpl->type = type.type;
+
+        for(const auto& st : type.states) {
+            std::shared_ptr<Moves> moves_ptr;
+            if(st.has_moves) moves_ptr = std::make_shared<Moves>(st.moves, board_size);
+
+            auto frames = std::make_shared<FrameSet>();
+            frames->reserve(st.frames.size());
+            for(const auto& f : st.frames) frames->push_back(image(f, img_factory));
+            auto graphics = gfx_factory.load(frames, to_json(st.graphics_cfg));
+
+            auto physics = phys_factory.create({0,0}, st.name, to_json(st.physics_cfg));
+
+            int id = static_cast<int>(tmpl->states.size());
+            tmpl->states.emplace_back(id, st.name, moves_ptr, graphics, physics);
+        }
+
+        PieceFactory::GlobalTrans trans;
+        for(const auto& t : type.transitions) trans[t.from][t.event] = t.to;
+        PieceFactory::link_states(*tmpl, trans, "asset bundle type " + type.type);
+
+        piece_factory.register_template(type.type, tmpl);
+    }
+}
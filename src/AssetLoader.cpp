@@ -0,0 +1,117 @@
+#include "../headers/AssetLoader.hpp"
+#include "../headers/SpriteCache.hpp"
+#include "../headers/Log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+}
+
+size_t AssetManifest::file_count() const {
+    size_t n = 0;
+    for(const auto& folder : sprite_folders) n += folder.second.size();
+    return n;
+}
+
+AssetLoader::AssetLoader(ImgFactoryPtr img_factory, std::pair<int,int> cell_size, unsigned threads_)
+    : img_factory(img_factory), cell_size(cell_size), threads(threads_) {
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+// ---------------------------------------------------------------------------
+std::vector<PiecePtr> AssetLoader::load_pieces(PieceFactory& piece_factory, const std::string& board_csv_path) {
+    AssetManifest manifest = scan(piece_factory.root(), board_csv_path);
+    if(decode_upfront) decode(manifest);
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto pieces = piece_factory.create_pieces(manifest.placements);
+    timings_.wire_ms = elapsed_ms(t0);
+
+    report();
+    return pieces;
+}
+
+AssetManifest AssetLoader::scan(const std::string& pieces_root, const std::string& board_csv_path) {
+    auto t0 = std::chrono::steady_clock::now();
+    AssetManifest manifest;
+    manifest.placements = PieceFactory::read_board_csv(board_csv_path);
+
+    std::set<std::string> types;
+    for(const auto& placement : manifest.placements) types.insert(placement.first);
+
+    for(const auto& type_name : types) {
+        fs::path states_root = fs::path(pieces_root) / type_name / "states";
+        if(!fs::exists(states_root) || !fs::is_directory(states_root)) continue;
+        for(const auto& entry : fs::directory_iterator(states_root)) {
+            if(!entry.is_directory()) continue;
+            std::string folder = (entry.path() / "sprites").string();
+            manifest.sprite_folders.emplace_back(folder, SpriteCache::list_frames(folder));
+        }
+    }
+
+    timings_.scan_ms = elapsed_ms(t0);
+    timings_.files = manifest.file_count();
+    return manifest;
+}
+
+void AssetLoader::decode(const AssetManifest& manifest) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::vector<const std::string*> files;
+    for(const auto& folder : manifest.sprite_folders) {
+        for(const auto& path : folder.second) files.push_back(&path);
+    }
+
+    unsigned n_workers = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(files.size(), 1)));
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for(size_t i = next++; i < files.size(); i = next++) {
+            try {
+                SpriteCache::instance().load(*files[i], cell_size, img_factory);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned t = 1; t < n_workers; ++t) pool.emplace_back(worker);
+    worker();
+    for(auto& th : pool) th.join();
+    if(error) std::rethrow_exception(error);
+
+    // Assemble the per-folder frame sets; every image is a cache hit by now.
+    for(const auto& folder : manifest.sprite_folders) {
+        SpriteCache::instance().load_frames(folder.first, folder.second, cell_size, img_factory);
+    }
+    if(build_atlas) SpriteCache::instance().build_atlas(img_factory);
+
+    timings_.decode_ms = elapsed_ms(t0);
+    timings_.threads = n_workers;
+}
+
+void AssetLoader::report() const {
+    if(decode_upfront) {
+        KFC_LOG_INFO("[LOAD] scan %.1f ms (%zu files) | decode %.1f ms on %u threads | wire %.1f ms",
+                     timings_.scan_ms, timings_.files, timings_.decode_ms, timings_.threads, timings_.wire_ms);
+    } else {
+        KFC_LOG_INFO("[LOAD] scan %.1f ms (%zu files) | decode deferred (lazy sprites) | wire %.1f ms",
+                     timings_.scan_ms, timings_.files, timings_.wire_ms);
+    }
+}
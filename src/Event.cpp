@@ -0,0 +1,83 @@
+#include "../headers/Event.hpp"
+
+#include <cctype>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const char* const kBuiltinNames[Events::kBuiltinCount] = {
+    "done", "move", "jump", "idle", "up", "down", "left", "right", "select", "switch", "cancel", "confirm"
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, EventId> ids;
+    std::deque<std::string> names;   // deque: references stay valid as it grows
+
+    Registry() {
+        for(EventId i = 0; i < Events::kBuiltinCount; ++i) {
+            names.emplace_back(kBuiltinNames[i]);
+            ids.emplace(names.back(), i);
+        }
+    }
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+std::string to_lower(std::string s) {
+    for(auto& ch : s) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return s;
+}
+
+bool equals_lower(const std::string& s, const char* lower) {
+    size_t i = 0;
+    for(; i < s.size() && lower[i]; ++i) {
+        if(std::tolower(static_cast<unsigned char>(s[i])) != lower[i]) return false;
+    }
+    return i == s.size() && !lower[i];
+}
+
+} // namespace
+
+EventId Events::intern(const std::string& name) {
+    std::string key = to_lower(name);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = r.ids.find(key);
+    if(it != r.ids.end()) return it->second;
+    if(r.names.size() >= 0x7fff) throw std::runtime_error("Too many distinct events: " + name);
+    EventId id = static_cast<EventId>(r.names.size());
+    r.names.push_back(key);
+    r.ids.emplace(std::move(key), id);
+    return id;
+}
+
+EventId Events::find(const std::string& name) {
+    for(EventId i = 0; i < kBuiltinCount; ++i) {
+        if(equals_lower(name, kBuiltinNames[i])) return i;
+    }
+    if(name.empty()) return kNone;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = r.ids.find(to_lower(name));
+    return it != r.ids.end() ? it->second : kNone;
+}
+
+const std::string& Events::name(EventId id) {
+    static const std::string none;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return id >= 0 && static_cast<size_t>(id) < r.names.size() ? r.names[static_cast<size_t>(id)] : none;
+}
+
+EventId Events::count() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return static_cast<EventId>(r.names.size());
+}
@@ -1,17 +1,34 @@
 #include "../headers/Game.hpp"
+#include "../headers/Log.hpp"
 #include <opencv2/opencv.hpp>
 
 // ---------------- Implementation --------------------
 Game::Game(std::vector<PiecePtr> pcs, Board board)
-    : pieces(pcs), board(board) {
+    : board(board), occupancy_(board.W_cells, board.H_cells),
+      clock_(std::make_shared<SteadyClock>()) {
+    for(auto & p : pcs) {
+        auto id = p->id;
+        piece_by_id[id] = pieces.insert(std::move(p));
+    }
     validate();
-    for(const auto & p : pieces) piece_by_id[p->id] = p;
-    start_tp = std::chrono::steady_clock::now();
+    sim_.resize(pieces.slot_count());
+    row_changed_.assign(pieces.slot_count(), 0);
+    for(auto it = pieces.begin(); it != pieces.end(); ++it) (*it)->bind(sim_, it.handle().index());
+    rebuild_occupancy();
+}
+
+Game::~Game() {
+    for(auto & p : pieces) {
+        if(p.use_count() > 1) p->detach();
+    }
 }
 
 int Game::game_time_ms() const {
-    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - start_tp).count());
+    return clock_->now_ms();
+}
+
+void Game::set_clock(ClockPtr clock) {
+    clock_ = clock ? clock : std::make_shared<SteadyClock>();
 }
 
 Board Game::clone_board() const {
@@ -19,237 +36,439 @@ Board Game::clone_board() const {
 }
 
 void Game::run(int num_iterations, bool is_with_graphics) {
-    running_ = true;
-    start_user_input_thread();
-    int start_ms = game_time_ms();
-    for(auto & p : pieces) p->reset(start_ms);
+    // Headless games have no window to read keys from; commands arrive
+    // through enqueue_command instead.
+    if(is_with_graphics) {
+        ui_ = std::make_unique<UiPump>([this](int key, int ts) { on_key(key, ts); },
+                                       [this]() { return game_time_ms(); });
+        ui_->start();
+    }
+    begin();
+    KFC_LOG_INFO("Graphics enabled: %s", is_with_graphics ? "true" : "false");
 
     run_game_loop(num_iterations, is_with_graphics);
 
     announce_win();
-    
-    // Close OpenCV windows if graphics were used
-    if(is_with_graphics) {
-        OpenCvImg::close_all_windows();
+
+    // Stops the UI thread, which closes the window
+    if(ui_) {
+        ui_->stop();
+        auto lat = ui_->latency();
+        KFC_LOG_INFO("[UI] input-to-display latency: %d samples, mean %.1f ms, max %d ms",
+                     lat.samples, lat.mean_ms, lat.max_ms);
+        ui_.reset();
     }
+    Log::instance().flush();
     running_ = false;
 }
 
-void Game::start_user_input_thread() {
+// UI thread: map a key read by UiPump to a Command, stamped with the time
+// the key was read.
+void Game::on_key(int key, int timestamp_ms) {
+    KFC_LOG_DEBUG("[INPUT] Key pressed: %d", key);
+    if (key == 27) { // ESC key
+        KFC_LOG_INFO("ESC pressed, exiting...");
+        running_ = false;
+        return;
+    }
+
+    CompactCommand cmd = CompactCommand::make(timestamp_ms, Events::kNone);
+
+    // Player 1 controls
+    if (key == 82) cmd = CompactCommand::make(timestamp_ms, Events::kUp, 1);
+    else if (key == 84) cmd = CompactCommand::make(timestamp_ms, Events::kDown, 1);
+    else if (key == 81) cmd = CompactCommand::make(timestamp_ms, Events::kLeft, 1);
+    else if (key == 83) cmd = CompactCommand::make(timestamp_ms, Events::kRight, 1);
+    else if (key == 13) cmd = CompactCommand::make(timestamp_ms, Events::kSelect, 1);
+    else if (key == 32) cmd = CompactCommand::make(timestamp_ms, Events::kSwitch, 0); // Space to switch player
+
+    // Player 2 controls
+    else if (key == 'w') cmd = CompactCommand::make(timestamp_ms, Events::kUp, 2);
+    else if (key == 's') cmd = CompactCommand::make(timestamp_ms, Events::kDown, 2);
+    else if (key == 'a') cmd = CompactCommand::make(timestamp_ms, Events::kLeft, 2);
+    else if (key == 'd') cmd = CompactCommand::make(timestamp_ms, Events::kRight, 2);
+    else if (key == 'f') cmd = CompactCommand::make(timestamp_ms, Events::kSelect, 2);
+
+    if (cmd.event != Events::kNone) {
+        KFC_LOG_DEBUG("[INPUT] Adding command to queue: %s (Player %d)", Events::name(cmd.event).c_str(), cmd.player_id);
+        enqueue_command(cmd);
+    } else {
+        KFC_LOG_DEBUG("[INPUT] Unknown key: %d", key);
+    }
+}
+
+// Reset every piece at the current clock time and arm the scheduler
+void Game::begin() {
     running_ = true;
-    std::cout << "[INPUT] Starting user input thread..." << std::endl;
-    
-    std::thread input_thread([this]() {
-        while (running_) {
-            int key = cv::waitKey(30) & 0xFF;
-            if (key != 255) {
-                std::cout << "[INPUT] Key pressed: " << key << std::endl;
-                Command cmd(game_time_ms(), "", "", {});
-                
-                // Player 1 controls
-                if (key == 82) cmd = Command(game_time_ms(), "", "up", {}, 1);
-                else if (key == 84) cmd = Command(game_time_ms(), "", "down", {}, 1);
-                else if (key == 81) cmd = Command(game_time_ms(), "", "left", {}, 1);
-                else if (key == 83) cmd = Command(game_time_ms(), "", "right", {}, 1);
-                else if (key == 13) cmd = Command(game_time_ms(), "", "select", {}, 1);
-                else if (key == 32) cmd = Command(game_time_ms(), "", "switch", {}, 0); // Space to switch player
-                
-                // Player 2 controls
-                else if (key == 'w') cmd = Command(game_time_ms(), "", "up", {}, 2);
-                else if (key == 's') cmd = Command(game_time_ms(), "", "down", {}, 2);
-                else if (key == 'a') cmd = Command(game_time_ms(), "", "left", {}, 2);
-                else if (key == 'd') cmd = Command(game_time_ms(), "", "right", {}, 2);
-                else if (key == 'f') cmd = Command(game_time_ms(), "", "select", {}, 2);
-                
-                if (!cmd.type.empty()) {
-                    std::cout << "[INPUT] Adding command to queue: " << cmd.type << " (Player " << cmd.player_id << ")" << std::endl;
-                    std::lock_guard<std::mutex> lock(queue_mutex_);
-                    user_input_queue.push(cmd);
-                    cv_.notify_one();
-                } else {
-                    std::cout << "[INPUT] Unknown key: " << key << std::endl;
-                }
-            }
+    int now = game_time_ms();
+    for(auto & p : pieces) p->reset(now);
+    rebuild_occupancy();
+    scheduler_.clear();
+    sim_now_ms_ = now;
+
+    KFC_LOG_INFO("Starting game loop with %zu pieces...", pieces.size());
+
+    // Initialize all pieces first
+    KFC_LOG_DEBUG("=== INITIALIZING ALL PIECES ===");
+    size_t i = 0;
+    for(auto it = pieces.begin(); it != pieces.end(); ++it, ++i) {
+        Piece& p = **it;
+        try {
+            if(p.update(now)) sync_piece(it.handle());
+            schedule_piece(it.handle(), now);
+            KFC_LOG_TRACE("[%zu/%zu] Initializing: %s - INITIALIZED (keeping position)", i + 1, pieces.size(), p.id.c_str());
+        } catch (const std::exception& e) {
+            KFC_LOG_ERROR("[%zu/%zu] Initializing: %s - ERROR: %s", i + 1, pieces.size(), p.id.c_str(), e.what());
         }
-    });
-    
-    input_thread.detach();
+    }
+    KFC_LOG_DEBUG("=== FINISHED INITIALIZING ALL PIECES ===");
+}
+
+int Game::advance(int ticks) {
+    int done = 0;
+    while(done < ticks && !finished()) {
+        int next = sim_now_ms_ + sim_tick_ms_;
+        clock_->sleep_until(next);
+        step(next);
+        ++done;
+    }
+    return done;
+}
+
+bool Game::finished() const {
+    return !running_ || is_win();
+}
+
+void Game::stop() {
+    running_ = false;
 }
 
 void Game::run_game_loop(int num_iterations, bool is_with_graphics) {
     int it_counter = 0;
-    std::cout << "Starting game loop with " << pieces.size() << " pieces..." << std::endl;
-    std::cout << "Graphics enabled: " << (is_with_graphics ? "true" : "false") << std::endl;
+
+    // Fixed-timestep core: pieces only ever see game time in whole ticks, so a
+    // slow or blocked frame delays the simulation but never coarsens it. The
+    // missed ticks run back to back (at most max_catch_up_ms_ per pass so the
+    // board still gets redrawn) and the board is drawn on its own cadence.
+    int sim_now = sim_now_ms_;
+    int next_render_ms = sim_now;
+    int ticks = 0;
+    bool stop = (num_iterations == 0);
+    while(!stop && !is_win() && running_) {
+        int wall = game_time_ms();
+
+        int budget = std::max(1, max_catch_up_ms_ / sim_tick_ms_);
+        while(!stop && sim_now + sim_tick_ms_ <= wall && budget-- > 0) {
+            sim_now += sim_tick_ms_;
+            step(sim_now);
+            // num_iterations counts simulation ticks; negative runs until exit
+            stop = num_iterations > 0 && ++ticks >= num_iterations;
+        }
+
+        if(!stop && is_with_graphics && wall >= next_render_ms) {
+            KFC_LOG_TRACE("=== Frame %d (t=%d ms) ===", it_counter++, sim_now);
+            if(!render_frame(sim_now)) return;
+            next_render_ms += render_interval_ms_;
+            if(next_render_ms < wall) next_render_ms = wall + render_interval_ms_;
+        }
+
+        // Sleep until the next tick or frame is due
+        int wake = sim_now + sim_tick_ms_;
+        if(is_with_graphics) wake = std::min(wake, next_render_ms);
+        clock_->sleep_until(wake);
+    }
+}
+
+void Game::set_timing(int sim_tick_ms, int render_interval_ms) {
+    sim_tick_ms_ = std::max(1, sim_tick_ms);
+    render_interval_ms_ = std::max(1, render_interval_ms);
+}
+
+// One simulation tick at game time now_ms
+void Game::step(int now_ms) {
+    sim_now_ms_ = now_ms;
+
+    // Wake only the pieces whose deadline has arrived; idle pieces cost nothing
+    due_.clear();
+    scheduler_.pop_due(now_ms, due_);
+    update_due(now_ms);
+    advance_moves(now_ms);
+
+    // Drain the commands queued so far; producers keep pushing meanwhile
+    for(size_t n = input_queue_.capacity(); n > 0 && input_queue_.try_pop(input_cmd_); --n) {
+        if(oldest_input_ms_ < 0) oldest_input_ms_ = input_cmd_.timestamp;
+        // The producer's stamp is its own clock (wall time, or whatever a
+        // client sent); the command takes effect at this tick.
+        input_cmd_.timestamp = now_ms;
+        process_input(input_cmd_);
+    }
+
+    resolve_collisions();
+}
+
+// Update the due pieces. The sim_ rows are advanced grouped by physics kind
+// (ascending within a kind); updates only touch their own row, so large
+// batches are split into chunks on the pool. The grid and scheduler are then
+// updated serially in due_ order, exactly as the single-threaded loop would.
+void Game::update_due(int now_ms) {
+    due_rows_.clear();
+    for(PieceHandle h : due_) due_rows_.push_back(h.index());
+    sim_.group_by_kind(due_rows_.data(), due_rows_.size());
+
+    size_t n = due_rows_.size();
+    size_t chunks = pool_ ? std::min<size_t>(pool_->size() * 2, n / kMinUpdateChunk) : 0;
+    if(chunks < 2) {
+        sim_.update_rows(due_rows_.data(), n, now_ms, row_changed_.data());
+    } else {
+        size_t per_chunk = (n + chunks - 1) / chunks;
+        pool_->parallel_for(chunks, [&](size_t c) {
+            size_t begin = c * per_chunk;
+            size_t end = std::min(n, begin + per_chunk);
+            if(begin < end) sim_.update_rows(due_rows_.data() + begin, end - begin, now_ms, row_changed_.data());
+        });
+    }
+
+    for(PieceHandle h : due_) {
+        if(row_changed_[h.index()]) sync_piece(h);
+        schedule_piece(h, now_ms);
+    }
+}
+
+// Moving pieces are not scheduled: sim_ integrates all of them in one pass
+// every tick, and only the ones that changed cell or arrived are synced.
+void Game::advance_moves(int now_ms) {
+    moved_rows_.clear();
+    sim_.advance_moves(now_ms, moved_rows_);
+    for(uint32_t row : moved_rows_) {
+        PieceHandle h = pieces.handle_at(row);
+        sync_piece(h);
+        schedule_piece(h, now_ms);
+    }
+}
+
+void Game::set_thread_pool(ThreadPool* pool) {
+    pool_ = pool;
+}
+
+// Draw the board at game time now_ms and hand it to the UI thread. Returns
+// false once the game has been asked to stop (ESC).
+bool Game::render_frame(int now) {
+    KFC_LOG_TRACE("Drawing graphics...");
+    // Create a copy of the board to draw pieces on
+    auto display_board = board.clone();
     
-    // Initialize all pieces first
-    int now = game_time_ms();
-    std::cout << "\n=== INITIALIZING ALL PIECES ===" << std::endl;
-    for(size_t i = 0; i < pieces.size(); ++i) {
-        auto& p = pieces[i];
-        std::cout << "[" << (i+1) << "/" << pieces.size() << "] Initializing: " << p->id;
+    int pieces_drawn = 0;
+    int pieces_failed = 0;
+    
+    // Pieces already drawn per cell, for the side-by-side offset
+    std::vector<uint8_t> drawn_at(static_cast<size_t>(board.W_cells) * board.H_cells, 0);
+
+    // Draw all pieces on the board
+    for(const auto& piece : pieces) {
+        auto cell = piece->current_cell();
         
         try {
-            p->update(now);
-            
-            if (p->state) {
-                std::cout << " - INITIALIZED (keeping position)" << std::endl;
-            } else {
-                std::cout << " - WARNING: NO STATE!" << std::endl;
+            // Update graphics before getting image
+            piece->update_graphics(now);
+            auto piece_img = piece->get_img();
+            if (!piece_img) {
+                pieces_failed++;
+                continue;
             }
+            
+            auto pos_m = display_board.cell_to_m(cell);
+            auto pos_pix = display_board.m_to_pix(pos_m);
+            
+            // Count pieces at same cell for proper offset
+            int pieces_at_cell = 0;
+            if(occupancy_.in_bounds(cell)) pieces_at_cell = drawn_at[occupancy_.index(cell)]++;
+            
+            // Offset only horizontally for same row with 80 spacing
+            int offset_x = pieces_at_cell * 80;
+            int offset_y = 0;  // No vertical offset
+            
+            piece_img->draw_on(*display_board.img, pos_pix.first + offset_x, pos_pix.second + offset_y);
+            pieces_drawn++;
+            
         } catch (const std::exception& e) {
-            std::cout << " - ERROR: " << e.what() << std::endl;
+            pieces_failed++;
         }
     }
-    std::cout << "=== FINISHED INITIALIZING ALL PIECES ===\n" << std::endl;
     
-    while(!is_win() && running_) {
-        std::cout << "\n=== Iteration " << it_counter << " ===" << std::endl;
-        now = game_time_ms();
+    if (pieces_drawn > 0) {
+        // Draw green border around current cursor position
+        auto cursor_pos_m = display_board.cell_to_m(cursor_pos_);
+        auto cursor_pos_pix = display_board.m_to_pix(cursor_pos_m);
+        int cell_size = 80;
+        display_board.img->draw_rect(cursor_pos_pix.first, cursor_pos_pix.second, 
+                                   cell_size, cell_size, {0, 255, 0}); // Green border
         
-        // Update all pieces
-        for(auto & p : pieces) {
-            p->update(now);
+        if(ui_) {
+            ui_->present(display_board.img, oldest_input_ms_);
+            oldest_input_ms_ = -1;
         }
+    }
+    return running_;
+}
 
-        update_cell2piece_map();
-
-        // Process user input with thread safety
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            // Process string commands from keyboard producers
-            while(!string_input_queue.empty()) {
-                auto cmd_str = string_input_queue.front();
-                string_input_queue.pop();
-                // Convert string command to Command object
-                // For now, create a simple command - this may need enhancement
-                Command cmd(now, "player1", cmd_str, {}, 1);
-                user_input_queue.push(cmd);
-            }
-            
-            while(!user_input_queue.empty()) {
-                auto cmd = user_input_queue.front();
-                user_input_queue.pop();
-                process_input(cmd);
-            }
-        }
+// ---------------------------------------------------------------------------
+// Occupancy grid
+// ---------------------------------------------------------------------------
+void Game::rebuild_occupancy() {
+    size_t cells = static_cast<size_t>(board.W_cells) * board.H_cells;
+    cell_pieces.assign(cells, {});
+    cell_is_dirty.assign(cells, 0);
+    dirty_cells.clear();
+    occupancy_.reset();
+    grid_cell.assign(pieces.slot_count(), {-1, -1});
+    for(auto it = pieces.begin(); it != pieces.end(); ++it) {
+        auto cell = (*it)->current_cell();
+        grid_cell[it.handle().index()] = cell;
+        grid_insert(it.handle(), cell);
+        mark_dirty(cell);
+    }
+}
 
-        if(is_with_graphics) {
-            std::cout << "Drawing graphics..." << std::endl;
-            // Create a copy of the board to draw pieces on
-            auto display_board = board.clone();
-            
-            int pieces_drawn = 0;
-            int pieces_failed = 0;
-            
-            // Draw all pieces on the board
-            for(size_t i = 0; i < pieces.size(); ++i) {
-                const auto& piece = pieces[i];
-                
-                auto cell = piece->current_cell();
-                
-                try {
-                    if (!piece->state) {
-                        pieces_failed++;
-                        continue;
-                    }
-                    
-                    if (!piece->state->graphics) {
-                        pieces_failed++;
-                        continue;
-                    }
-                    
-                    // Update graphics before getting image
-                    piece->state->graphics->update(now);
-                    auto piece_img = piece->state->graphics->get_img();
-                    if (!piece_img) {
-                        pieces_failed++;
-                        continue;
-                    }
-                    
-                    auto pos_m = display_board.cell_to_m(cell);
-                    auto pos_pix = display_board.m_to_pix(pos_m);
-                    
-                    // Count pieces at same cell for proper offset
-                    int pieces_at_cell = 0;
-                    for(size_t j = 0; j < pieces.size(); ++j) {
-                        if(j < i && pieces[j]->current_cell() == cell) {
-                            pieces_at_cell++;
-                        }
-                    }
-                    
-                    // Offset only horizontally for same row with 80 spacing
-                    int offset_x = pieces_at_cell * 80;
-                    int offset_y = 0;  // No vertical offset
-                    
-                    piece_img->draw_on(*display_board.img, pos_pix.first + offset_x, pos_pix.second + offset_y);
-                    pieces_drawn++;
-                    
-                } catch (const std::exception& e) {
-                    pieces_failed++;
-                }
-            }
-            
-            if (pieces_drawn > 0) {
-                // Draw green border around current cursor position
-                auto cursor_pos_m = display_board.cell_to_m(cursor_pos_);
-                auto cursor_pos_pix = display_board.m_to_pix(cursor_pos_m);
-                int cell_size = 80;
-                display_board.img->draw_rect(cursor_pos_pix.first, cursor_pos_pix.second, 
-                                           cell_size, cell_size, {0, 255, 0}); // Green border
-                
-                display_board.show();
-                // Check for ESC key to exit
-                int key = cv::waitKey(1);
-                if(key == 27) { // ESC key
-                    std::cout << "ESC pressed, exiting..." << std::endl;
-                    return;
-                }
-            }
-        }
+void Game::sync_piece(PieceHandle h) {
+    auto cell = sim_.current_cell(h.index());
+    auto& filed = grid_cell[h.index()];
+    if(filed != cell) {
+        grid_remove(h, filed);
+        grid_insert(h, cell);
+        filed = cell;
+    }
+    // A state change alone can also enable a capture on the same cell
+    mark_dirty(cell);
+}
 
-        resolve_collisions();
+void Game::grid_insert(PieceHandle h, const std::pair<int,int>& cell) {
+    if(!occupancy_.in_bounds(cell)) return;
+    cell_pieces[occupancy_.index(cell)].push_back(h);
+    occupancy_.set(cell);
+}
 
-        ++it_counter;
-        // Run indefinitely unless ESC is pressed or win condition is met
-        
-        // Frame pacing - sleep for ~30ms to achieve ~30 FPS
-        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+void Game::grid_remove(PieceHandle h, const std::pair<int,int>& cell) {
+    if(!occupancy_.in_bounds(cell)) return;
+    auto& at = cell_pieces[occupancy_.index(cell)];
+    at.erase(std::remove(at.begin(), at.end(), h), at.end());
+    if(at.empty()) occupancy_.clear(cell);
+}
+
+void Game::mark_dirty(const std::pair<int,int>& cell) {
+    if(!occupancy_.in_bounds(cell)) return;
+    int i = occupancy_.index(cell);
+    if(!cell_is_dirty[i]) {
+        cell_is_dirty[i] = 1;
+        dirty_cells.push_back(i);
+    }
+}
+
+const std::vector<PieceHandle>* Game::pieces_at(const std::pair<int,int>& cell) const {
+    if(!occupancy_.in_bounds(cell)) return nullptr;
+    const auto& at = cell_pieces[occupancy_.index(cell)];
+    return at.empty() ? nullptr : &at;
+}
+
+Piece* Game::resolve(PieceHandle h) const {
+    auto p = pieces.get(h);
+    return p ? p->get() : nullptr;
+}
+
+void Game::schedule_piece(PieceHandle h, int now_ms) {
+    // Moving pieces are advanced every tick by advance_moves
+    int deadline = sim_.kind[h.index()] == PhysicsKind::Move ? BasePhysics::kNoDeadline
+                                                             : sim_.next_deadline_ms(h.index(), now_ms);
+    if(deadline == BasePhysics::kNoDeadline) {
+        scheduler_.cancel(h);
+    } else {
+        // Never re-arm for the tick we are in
+        scheduler_.schedule(h, std::max(deadline, now_ms + 1));
     }
 }
 
-void Game::update_cell2piece_map() {
-    std::lock_guard<std::mutex> lock(positions_mutex_);
-    pos.clear();
-    for(const auto& p : pieces) {
-        auto cell = p->current_cell();
-        pos[cell].push_back(p);
+bool Game::is_legal_move(const Piece& piece, const std::pair<int,int>& dst_cell) const {
+    const auto& moves = piece.state().moves;
+    return moves && moves->is_valid(piece.current_cell(), dst_cell, occupancy_);
+}
+
+// Player 1 plays white, player 2 black (the W / B suffix of the piece type)
+int Game::owner_of(const Piece& piece) {
+    const std::string& type = piece.tmpl->type;
+    if (type.empty()) return 0;
+    return type.back() == 'W' ? 1 : type.back() == 'B' ? 2 : 0;
+}
+
+// Commands for a piece come from any producer (UI, bots, GameHost clients),
+// so check them against the current board before they reach the physics:
+// only the piece's owner may command it, cells, if any, must start where the
+// piece is, and a move needs exactly a source and a legal destination.
+bool Game::is_valid_piece_command(const CompactCommand& cmd) const {
+    Piece* piece = resolve(cmd.piece);
+    if (owner_of(*piece) != cmd.player_id) {
+        KFC_LOG_INFO("[PROCESS] Dropping %s for %s from player %d: not their piece",
+                     Events::name(cmd.event).c_str(), piece->id.c_str(), cmd.player_id);
+        return false;
+    }
+    auto cell = sim_.current_cell(cmd.piece.index());
+    if (cmd.cell_count > 0 && cmd.cell(0) != cell) {
+        KFC_LOG_INFO("[PROCESS] Dropping %s for %s: it starts at (%d,%d), the piece is at (%d,%d)",
+                     Events::name(cmd.event).c_str(), piece->id.c_str(),
+                     cmd.cell(0).first, cmd.cell(0).second, cell.first, cell.second);
+        return false;
+    }
+    if (cmd.event == Events::kMove) {
+        if (cmd.cell_count != 2) {
+            KFC_LOG_INFO("[PROCESS] Dropping move for %s: %d cells instead of 2", piece->id.c_str(), cmd.cell_count);
+            return false;
+        }
+        if (!is_legal_move(*piece, cmd.cell(1))) {
+            KFC_LOG_INFO("[PROCESS] Dropping illegal move: %s to (%d,%d)", piece->id.c_str(),
+                         cmd.cell(1).first, cmd.cell(1).second);
+            return false;
+        }
     }
+    return true;
 }
 
-void Game::process_input(const Command& cmd) {
-    std::lock_guard<std::mutex> lock(input_mutex_);
-    std::cout << "[PROCESS] Processing command: " << cmd.type << " from Player " << cmd.player_id << std::endl;
+// Sim thread only: the selection state and the grid are never touched from
+// anywhere else, so draining needs no lock.
+void Game::process_input(const CompactCommand& cmd) {
+    KFC_LOG_DEBUG("[PROCESS] Processing command: %s from Player %d", Events::name(cmd.event).c_str(), cmd.player_id);
     
-    if (cmd.type == "switch") {
+    // Commands addressed to a piece (e.g. a confirmed "move") drive its state
+    if (cmd.piece.valid()) {
+        if (!pieces.contains(cmd.piece)) return;   // captured since the command was sent
+        if (!is_valid_piece_command(cmd)) return;
+        sim_.transition(cmd.piece.index(), cmd);
+        sync_piece(cmd.piece);
+        schedule_piece(cmd.piece, sim_now_ms_);
+        return;
+    }
+
+    if (cmd.event == Events::kSwitch) {
         current_player_ = (current_player_ == 1) ? 2 : 1;
-        std::cout << "[PROCESS] Switched to Player " << current_player_ << std::endl;
+        KFC_LOG_INFO("[PROCESS] Switched to Player %d", current_player_);
         return;
     }
     
-    if (cmd.player_id != current_player_) {
-        std::cout << "[PROCESS] Ignoring command from inactive player " << cmd.player_id << std::endl;
+    // Player 0: the local mouse/keyboard UI (handle_*), acting for whoever's turn it is
+    if (cmd.player_id != 0 && cmd.player_id != current_player_) {
+        KFC_LOG_DEBUG("[PROCESS] Ignoring command from inactive player %d", cmd.player_id);
         return;
     }
     
-    if (cmd.type == "up") move_cursor(0, -1);
-    else if (cmd.type == "down") move_cursor(0, 1);
-    else if (cmd.type == "left") move_cursor(-1, 0);
-    else if (cmd.type == "right") move_cursor(1, 0);
-    else if (cmd.type == "select") {
-        auto cell_pieces_it = pos.find(cursor_pos_);
-        if (cell_pieces_it != pos.end() && !cell_pieces_it->second.empty()) {
-            selected_piece_ = cell_pieces_it->second[0];
-            std::cout << "[PROCESS] Selected piece: " << selected_piece_->id << " at cursor position" << std::endl;
+    if (cmd.event == Events::kUp) move_cursor(0, -1);
+    else if (cmd.event == Events::kDown) move_cursor(0, 1);
+    else if (cmd.event == Events::kLeft) move_cursor(-1, 0);
+    else if (cmd.event == Events::kRight) move_cursor(1, 0);
+    else if (cmd.event == Events::kCancel) cancel_selection();
+    else if (cmd.event == Events::kConfirm) confirm_move();
+    else if (cmd.event == Events::kSelect && cmd.cell_count > 0) click_cell(cmd.cell(0));
+    else if (cmd.event == Events::kSelect) {
+        auto at = pieces_at(cursor_pos_);
+        if (at) {
+            selected_piece_ = (*at)[0];
+            KFC_LOG_INFO("[PROCESS] Selected piece: %s at cursor position", resolve(selected_piece_)->id.c_str());
         }
     }
 }
@@ -260,9 +479,9 @@ void Game::resolve_collisions() {
 
 void Game::announce_win() const {
     if(is_win()) {
-        std::cout << "Game Over - Victory achieved!" << std::endl;
+        KFC_LOG_INFO("Game Over - Victory achieved!");
     } else {
-        std::cout << "Game ended without victory condition." << std::endl;
+        KFC_LOG_INFO("Game ended without victory condition.");
     }
 }
 
@@ -274,6 +493,11 @@ void Game::validate() {
     if(board.W_cells <= 0 || board.H_cells <= 0) {
         throw InvalidBoard("Invalid board dimensions");
     }
+
+    // Any move on the board must fit MoveIntegrator's fixed-point range
+    if(board.W_cells > MoveIntegrator::kMaxCells + 1 || board.H_cells > MoveIntegrator::kMaxCells + 1) {
+        throw InvalidBoard("Board larger than " + std::to_string(MoveIntegrator::kMaxCells + 1) + " cells per side");
+    }
 }
 
 bool Game::is_win() const {
@@ -281,122 +505,162 @@ bool Game::is_win() const {
     return false;
 }
 
-void Game::enqueue_command(const Command& cmd) {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    user_input_queue.push(cmd);
-    cv_.notify_one();
+bool Game::enqueue_command(const Command& cmd) {
+    if(!CompactCommand::fits(cmd)) {
+        KFC_LOG_WARN("[INPUT] Dropping %s: %zu params or a value out of range", cmd.type.c_str(), cmd.params.size());
+        return false;
+    }
+    PieceHandle piece = cmd.piece;
+    if(!piece.valid() && !cmd.piece_id.empty()) {
+        piece = find_piece_by_id(cmd.piece_id);
+        if(!piece.valid()) {
+            KFC_LOG_DEBUG("[INPUT] Unknown piece %s, dropping: %s", cmd.piece_id.c_str(), cmd.type.c_str());
+            return false;
+        }
+    }
+    return enqueue_command(CompactCommand::from(cmd, piece));
+}
+
+bool Game::enqueue_command(const CompactCommand& cmd) {
+    if(input_queue_.try_push(cmd)) return true;
+    KFC_LOG_WARN("[INPUT] Command queue full, dropping: %s", Events::name(cmd.event).c_str());
+    return false;
 }
 
-// Enhanced user interaction methods from CTD25_1
+// Enhanced user interaction methods from CTD25_1. These may run on a UI
+// thread, so they only queue commands; process_input applies them on the
+// sim thread.
 void Game::handle_mouse_click(int x, int y) {
-    std::lock_guard<std::mutex> lock(input_mutex_);
-    if (!is_selecting_target_) {
-        select_piece_at(x, y);
-    } else {
-        // Move selected piece to clicked position
-        if (selected_piece_) {
-            Command move_cmd(game_time_ms(), selected_piece_->id, "move", {{cursor_pos_.first, cursor_pos_.second}, {x, y}}, 1);
-            enqueue_command(move_cmd);
-        }
-        cancel_selection();
-    }
+    enqueue_command(CompactCommand::make(game_time_ms(), Events::kSelect, 0).add_cell({x, y}));
 }
 
 void Game::handle_key_press(int key) {
-    std::lock_guard<std::mutex> lock(input_mutex_);
+    EventId event = Events::kNone;
     switch(key) {
         case 27: // ESC
-            cancel_selection();
+            event = Events::kCancel;
             break;
         case 13: // Enter
-            confirm_move();
+            event = Events::kConfirm;
             break;
         // Arrow keys for cursor movement
         case 'w': case 'W':
-            move_cursor(0, -1);
+            event = Events::kUp;
             break;
         case 's': case 'S':
-            move_cursor(0, 1);
+            event = Events::kDown;
             break;
         case 'a': case 'A':
-            move_cursor(-1, 0);
+            event = Events::kLeft;
             break;
         case 'd': case 'D':
-            move_cursor(1, 0);
+            event = Events::kRight;
             break;
     }
+    if (event != Events::kNone) enqueue_command(CompactCommand::make(game_time_ms(), event, 0));
+}
+
+// A click selects the piece under it, or moves the selected piece there
+void Game::click_cell(const std::pair<int,int>& cell) {
+    if (!is_selecting_target_) {
+        select_piece_at(cell.first, cell.second);
+    } else {
+        Piece* selected = resolve(selected_piece_);
+        if (selected && is_legal_move(*selected, cell)) {
+            // Same source cell the legality check used
+            auto move_cmd = CompactCommand::make(sim_now_ms_, Events::kMove, current_player_, selected_piece_)
+                                .add_cell(selected->current_cell()).add_cell(cell);
+            enqueue_command(move_cmd);
+        }
+        cancel_selection();
+    }
 }
 
 void Game::select_piece_at(int x, int y) {
-    auto cell_pieces_it = pos.find({x, y});
-    if (cell_pieces_it != pos.end() && !cell_pieces_it->second.empty()) {
-        selected_piece_ = cell_pieces_it->second[0];
+    auto at = pieces_at({x, y});
+    if (at) {
+        selected_piece_ = (*at)[0];
         cursor_pos_ = {x, y};
         is_selecting_target_ = true;
-        std::cout << "Selected piece: " << selected_piece_->id << " at " << cell_to_chess_notation(x, y) << std::endl;
+        KFC_LOG_INFO("Selected piece: %s at %s", resolve(selected_piece_)->id.c_str(), cell_to_chess_notation(x, y).c_str());
     }
 }
 
 void Game::move_cursor(int dx, int dy) {
     cursor_pos_.first = std::max(0, std::min(board.W_cells - 1, cursor_pos_.first + dx));
     cursor_pos_.second = std::max(0, std::min(board.H_cells - 1, cursor_pos_.second + dy));
-    std::cout << "Cursor moved to: (" << cursor_pos_.first << "," << cursor_pos_.second << ")" << std::endl;
+    KFC_LOG_DEBUG("Cursor moved to: (%d,%d)", cursor_pos_.first, cursor_pos_.second);
 }
 
 void Game::confirm_move() {
-    if (selected_piece_ && is_selecting_target_) {
-        auto start_cell = selected_piece_->current_cell();
-        Command move_cmd(game_time_ms(), selected_piece_->id, "move", {start_cell, cursor_pos_}, 1);
+    Piece* selected = resolve(selected_piece_);
+    if (selected && is_selecting_target_ && !is_legal_move(*selected, cursor_pos_)) {
+        KFC_LOG_INFO("Illegal move: %s to %s", selected->id.c_str(), cell_to_chess_notation(cursor_pos_.first, cursor_pos_.second).c_str());
+    } else if (selected && is_selecting_target_) {
+        auto start_cell = selected->current_cell();
+        auto move_cmd = CompactCommand::make(sim_now_ms_, Events::kMove, current_player_, selected_piece_)
+                            .add_cell(start_cell).add_cell(cursor_pos_);
         enqueue_command(move_cmd);
-        std::cout << "Move confirmed: " << selected_piece_->id << " to " << cell_to_chess_notation(cursor_pos_.first, cursor_pos_.second) << std::endl;
+        KFC_LOG_INFO("Move confirmed: %s to %s", selected->id.c_str(), cell_to_chess_notation(cursor_pos_.first, cursor_pos_.second).c_str());
     }
     cancel_selection();
 }
 
 void Game::cancel_selection() {
-    selected_piece_ = nullptr;
+    selected_piece_ = PieceHandle();
     is_selecting_target_ = false;
-    std::cout << "Selection cancelled" << std::endl;
+    KFC_LOG_DEBUG("Selection cancelled");
 }
 
 std::string Game::cell_to_chess_notation(int x, int y) {
     return std::string(1, 'a' + y) + std::to_string(x + 1);
 }
 
-PiecePtr Game::find_piece_by_id(const std::string& id) {
+PieceHandle Game::find_piece_by_id(const std::string& id) const {
     auto it = piece_by_id.find(id);
-    return (it != piece_by_id.end()) ? it->second : nullptr;
+    return (it != piece_by_id.end()) ? it->second : PieceHandle();
 }
 
 void Game::check_captures() {
-    // Enhanced capture logic
-    for (const auto& [cell, pieces_at_cell] : pos) {
-        if (pieces_at_cell.size() > 1) {
-            // Multiple pieces at same cell - check for captures
+    // Only cells that changed since the last check can produce a capture
+    for (int cell_idx : dirty_cells) {
+        cell_is_dirty[cell_idx] = 0;
+        if (cell_pieces[cell_idx].size() > 1) {
+            // Multiple pieces at same cell - check for captures (on a copy:
+            // capture_piece removes from the grid)
+            auto pieces_at_cell = cell_pieces[cell_idx];
             for (size_t i = 0; i < pieces_at_cell.size(); ++i) {
                 for (size_t j = i + 1; j < pieces_at_cell.size(); ++j) {
-                    auto piece1 = pieces_at_cell[i];
-                    auto piece2 = pieces_at_cell[j];
+                    PieceHandle h1 = pieces_at_cell[i];
+                    PieceHandle h2 = pieces_at_cell[j];
+                    if (!pieces.contains(h1) || !pieces.contains(h2)) continue;   // already captured this pass
+                    const StateTemplate& piece1 = sim_.state(h1.index());
+                    const StateTemplate& piece2 = sim_.state(h2.index());
                     
-                    if (piece1->state->can_capture() && piece2->state->can_be_captured()) {
-                        capture_piece(piece2, piece1);
-                    } else if (piece2->state->can_capture() && piece1->state->can_be_captured()) {
-                        capture_piece(piece1, piece2);
+                    if (piece1.can_capture() && piece2.can_be_captured()) {
+                        capture_piece(h2, h1);
+                    } else if (piece2.can_capture() && piece1.can_be_captured()) {
+                        capture_piece(h1, h2);
                     }
                 }
             }
         }
     }
+    dirty_cells.clear();
 }
 
-void Game::capture_piece(PiecePtr captured, PiecePtr captor) {
-    std::cout << "Piece captured: " << captured->id << " by " << captor->id << std::endl;
-    
-    // Remove captured piece from pieces vector
-    pieces.erase(std::remove(pieces.begin(), pieces.end(), captured), pieces.end());
-    
-    // Remove from piece_by_id map
-    piece_by_id.erase(captured->id);
+void Game::capture_piece(PieceHandle captured, PieceHandle captor) {
+    KFC_LOG_INFO("Piece captured: %s by %s", resolve(captured)->id.c_str(), resolve(captor)->id.c_str());
+
+    // Remove from the occupancy grid and the scheduler, then free the slot;
+    // every other handle (and piece_by_id) stays valid.
+    grid_remove(captured, grid_cell[captured.index()]);
+    grid_cell[captured.index()] = {-1, -1};
+    scheduler_.cancel(captured);
+    PiecePtr& piece = *pieces.get(captured);
+    if (piece.use_count() > 1) piece->detach();
+    sim_.release_row(captured.index());
+    pieces.remove(captured);
 }
 
 std::string Game::get_position_key(int x, int y) {
@@ -404,8 +668,8 @@ std::string Game::get_position_key(int x, int y) {
 }
 
 // Factory function implementation
-Game create_game(const std::string& pieces_root, ImgFactoryPtr img_factory) {
-    std::cout << "Creating game from pieces root: " << pieces_root << std::endl;
+Game create_game(const std::string& pieces_root, ImgFactoryPtr img_factory, bool lazy_sprites) {
+    KFC_LOG_INFO("Creating game from pieces root: %s", pieces_root.c_str());
     
     // Load board image
     std::string board_img_path = pieces_root + "board.png";
@@ -418,16 +682,42 @@ Game create_game(const std::string& pieces_root, ImgFactoryPtr img_factory) {
     Board board(80, 80, 8, 8, board_img);
     
     // Create graphics factory
-    GraphicsFactory gfx_factory(img_factory);
+    GraphicsFactory gfx_factory(img_factory, lazy_sprites);
     
     // Create piece factory
     PieceFactory piece_factory(board, pieces_root, gfx_factory);
     
-    // Load pieces from board.csv
+    // Load pieces from board.csv: scan assets, decode them in parallel, then wire
     std::string board_csv_path = pieces_root + "board.csv";
-    auto pieces = piece_factory.create_pieces_from_board_csv(board_csv_path);
+    AssetLoader loader(img_factory, {board.cell_W_pix, board.cell_H_pix});
+    loader.set_decode_upfront(!lazy_sprites);
+    auto pieces = loader.load_pieces(piece_factory, board_csv_path);
     
-    std::cout << "Created " << pieces.size() << " pieces" << std::endl;
+    KFC_LOG_INFO("Created %zu pieces", pieces.size());
     
+    return Game(pieces, board);
+}
+
+Game create_game_from_bundle(const std::string& bundle_path, ImgFactoryPtr img_factory) {
+    KFC_LOG_INFO("Creating game from asset bundle: %s", bundle_path.c_str());
+    auto t0 = std::chrono::steady_clock::now();
+
+    auto bundle = AssetBundle::open(bundle_path);
+    auto board_img = bundle->image(bundle->board_image, img_factory);
+    if (!board_img) {
+        throw std::runtime_error("Failed to load board image from bundle: " + bundle_path);
+    }
+
+    Board board(bundle->cell_size.second, bundle->cell_size.first,
+                bundle->board_cells.first, bundle->board_cells.second, board_img);
+
+    GraphicsFactory gfx_factory(img_factory);
+    PieceFactory piece_factory(board, "", gfx_factory);
+    bundle->register_templates(piece_factory, board, gfx_factory, img_factory);
+    auto pieces = piece_factory.create_pieces(bundle->placements);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    KFC_LOG_INFO("Created %zu pieces from bundle in %.1f ms", pieces.size(), ms);
+
     return Game(pieces, board);
 }
\ No newline at end of file
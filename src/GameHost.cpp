@@ -0,0 +1,97 @@
+#include "../headers/GameHost.hpp"
+#include "../headers/Log.hpp"
+
+#include <algorithm>
+
+GameHost::GameHost(unsigned threads) : pool_(threads) {
+    KFC_LOG_INFO("[HOST] Running games on %u threads", pool_.size());
+}
+
+GameHost::GameId GameHost::add_game(std::vector<PiecePtr> pieces, const Board& board, int max_ticks) {
+    auto match = std::make_unique<Match>();
+    match->game = std::make_unique<Game>(std::move(pieces), board);
+    match->game->set_clock(std::make_shared<VirtualClock>());
+    match->game->set_thread_pool(&pool_);   // only used for very large batches
+    match->game->begin();
+    match->max_ticks = max_ticks;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    match->id = next_id_++;
+    GameId id = match->id;
+    matches_.emplace(id, std::move(match));
+    return id;
+}
+
+bool GameHost::stop(GameId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = matches_.find(id);
+    if(it == matches_.end()) return false;
+    it->second->game->stop();
+    return true;
+}
+
+bool GameHost::enqueue(GameId id, const Command& cmd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = matches_.find(id);
+    return it != matches_.end() && it->second->game->enqueue_command(cmd);
+}
+
+bool GameHost::enqueue(GameId id, const CompactCommand& cmd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = matches_.find(id);
+    return it != matches_.end() && it->second->game->enqueue_command(cmd);
+}
+
+// ---------------------------------------------------------------------------
+size_t GameHost::step_all(int slice_ticks) {
+    std::vector<Match*> live;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        live.reserve(matches_.size());
+        for(auto& entry : matches_) live.push_back(entry.second.get());
+    }
+    // Deterministic task order regardless of hash-map layout
+    std::sort(live.begin(), live.end(), [](const Match* a, const Match* b) { return a->id < b->id; });
+
+    pool_.parallel_for(live.size(), [&](size_t i) {
+        Match& m = *live[i];
+        int budget = m.max_ticks < 0 ? slice_ticks : std::min(slice_ticks, m.max_ticks - m.ticks);
+        m.ticks += m.game->advance(budget);
+    });
+
+    // Finished games are destroyed after the lock is released
+    std::vector<std::unique_ptr<Match>> retired;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(Match* m : live) {
+        bool out_of_ticks = m->max_ticks >= 0 && m->ticks >= m->max_ticks;
+        if(!m->game->finished() && !out_of_ticks) continue;
+
+        Result r;
+        r.id = m->id;
+        r.ticks = m->ticks;
+        r.sim_time_ms = m->game->sim_time_ms();
+        r.won = m->game->won();
+        r.pieces_left = m->game->pieces.size();
+        results_.push_back(r);
+        auto it = matches_.find(m->id);
+        retired.push_back(std::move(it->second));
+        matches_.erase(it);
+    }
+    return matches_.size();
+}
+
+void GameHost::run_all(int slice_ticks) {
+    while(step_all(slice_ticks) > 0) {}
+}
+
+std::vector<GameHost::Result> GameHost::take_results() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Result> out;
+    out.swap(results_);
+    return out;
+}
+
+size_t GameHost::live_games() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return matches_.size();
+}
@@ -1,76 +1,61 @@
 #include "../headers/Graphics.hpp"
+#include "../headers/Log.hpp"
 
 #include <algorithm>
 #include <chrono>
 #include <stdexcept>
-#include <filesystem>
-#include <iostream>
 
 Graphics::Graphics(const std::string& sprites_folder,
 	std::pair<int, int> cell_size,
 	ImgFactoryPtr img_factory,
-	bool loop_, double fps_)
+	bool loop_, double fps_, bool lazy_)
 
 	: loop(loop_), fps(fps_), frame_duration_ms(1000.0 / fps_) {
 
-    namespace fs = std::filesystem;
-    if(!sprites_folder.empty() && img_factory) {
-        std::vector<fs::path> pngs;
-        fs::path root(sprites_folder);
-        if(fs::exists(root) && fs::is_directory(root)) {
-            for(const auto& entry : fs::directory_iterator(root)) {
-                if(entry.is_regular_file() && entry.path().extension() == ".png") {
-                    pngs.push_back(entry.path());
-                }
-            }
-            // Sort files numerically (1.png, 2.png, 3.png, etc.)
-            std::sort(pngs.begin(), pngs.end(), [](const fs::path& a, const fs::path& b) {
-                std::string stem_a = a.stem().string();
-                std::string stem_b = b.stem().string();
-                
-                // Convert to numbers for proper numerical sorting
-                int num_a = std::stoi(stem_a);
-                int num_b = std::stoi(stem_b);
-                
-                return num_a < num_b;
-            });
-            
-            std::cout << "Loading frames in order:" << std::endl;
-            for(size_t i = 0; i < pngs.size(); ++i) {
-                const auto& p = pngs[i];
-                std::cout << "Frame " << i << ": " << p.filename().string() << std::endl;
-                auto img_ptr = img_factory->load(p.string(), {80, 80});
-                if(img_ptr) {
-                    frames.push_back(img_ptr);
-                }
-            }
-        }
+    if(lazy_ && img_factory) {
+        lazy = true;
+        this->sprites_folder = SpriteCache::canonical_path(sprites_folder);
+        this->frame_paths = SpriteCache::list_frames(sprites_folder);
+        this->cell_size = cell_size;
+        this->img_factory = img_factory;
+    } else if(img_factory) {
+        frames = SpriteCache::instance().load_frames(sprites_folder, cell_size, img_factory);
     }
+    if(!frames) frames = std::make_shared<const FrameSet>();
 }
 
-void Graphics::reset(const Command& cmd) {
-	start_ms = cmd.timestamp;
-	cur_frame = 0;
+Graphics::Graphics(FrameSetPtr frames_, bool loop_, double fps_)
+	: frames(frames_ ? frames_ : std::make_shared<const FrameSet>()),
+	  loop(loop_), fps(fps_), frame_duration_ms(1000.0 / fps_) {}
+
+void Graphics::reset(GraphicsRuntime& rt, const CompactCommand& cmd) const {
+	rt.start_ms = cmd.timestamp;
+	rt.cur_frame = 0;
 }
 
-void Graphics::update(int now_ms) {
-	if (frames.empty()) return;
+void Graphics::update(GraphicsRuntime& rt, int now_ms) const {
+	size_t count = frame_count();
+	if (count == 0) return;
 	
-	int elapsed = now_ms - start_ms;
+	int elapsed = now_ms - rt.start_ms;
 	double frames_passed_exact = elapsed / frame_duration_ms;
 	size_t frames_passed = static_cast<size_t>(frames_passed_exact);
 	
 
 	
 	if (loop) {
-		cur_frame = frames_passed % frames.size();
+		rt.cur_frame = frames_passed % count;
 	} else {
-		cur_frame = std::min(frames_passed, frames.size() - 1);
+		rt.cur_frame = std::min(frames_passed, count - 1);
 	}
 }
 
-const ImgPtr Graphics::get_img() const {
-	if (frames.empty()) throw std::runtime_error("Graphics has no frames loaded");
-	std::cout << "[FRAME] Showing frame " << cur_frame << "/" << frames.size() << " (should be image " << (cur_frame + 1) << ".png)" << std::endl;
-	return frames[cur_frame];
+const ImgPtr Graphics::get_img(const GraphicsRuntime& rt) const {
+	FrameSetPtr current = lazy
+		? SpriteCache::instance().acquire_lru(sprites_folder, frame_paths, cell_size, img_factory)
+		: frames;
+	if (current->empty()) throw std::runtime_error("Graphics has no frames loaded");
+	size_t idx = std::min(rt.cur_frame, current->size() - 1);
+	KFC_LOG_TRACE("[FRAME] Showing frame %zu/%zu (should be image %zu.png)", idx, current->size(), idx + 1);
+	return (*current)[idx];
 }
\ No newline at end of file
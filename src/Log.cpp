@@ -0,0 +1,106 @@
+#include "../headers/Log.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+
+LogLevel level_from_env() {
+    const char* env = std::getenv("KFC_LOG_LEVEL");
+    if(!env) return LogLevel::Info;
+    std::string v(env);
+    if(v == "trace") return LogLevel::Trace;
+    if(v == "debug") return LogLevel::Debug;
+    if(v == "warn")  return LogLevel::Warn;
+    if(v == "error") return LogLevel::Error;
+    if(v == "off")   return LogLevel::Off;
+    return LogLevel::Info;
+}
+
+} // namespace
+
+Log& Log::instance() {
+    static Log log;
+    return log;
+}
+
+Log::Log() : ring_(new Slot[kCapacity]) {
+    for(size_t i = 0; i < kCapacity; ++i) ring_[i].seq.store(i, std::memory_order_relaxed);
+    set_level(level_from_env());
+    worker_ = std::thread([this]() { drain_loop(); });
+}
+
+Log::~Log() {
+    stop_.store(true, std::memory_order_release);
+    if(worker_.joinable()) worker_.join();
+}
+
+// ---------------------------------------------------------------------------
+// Bounded MPMC ring (per-slot sequence numbers): a slot is free for position
+// p when seq == p and readable when seq == p + 1.
+void Log::write(LogLevel level, const char* fmt, ...) {
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for(;;) {
+        slot = &ring_[pos & (kCapacity - 1)];
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if(diff == 0) {
+            if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if(diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);   // ring full
+            return;
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(slot->text, kSlotBytes, fmt, args);
+    va_end(args);
+    slot->level = level;
+    slot->seq.store(pos + 1, std::memory_order_release);
+}
+
+bool Log::drain_some() {
+    bool any = false;
+    uint64_t pos = drained_.load(std::memory_order_relaxed);
+    for(;;) {
+        Slot& slot = ring_[pos & (kCapacity - 1)];
+        if(slot.seq.load(std::memory_order_acquire) != pos + 1) break;
+        FILE* out = slot.level >= LogLevel::Warn ? stderr : stdout;
+        std::fputs(slot.text, out);
+        std::fputc('\n', out);
+        slot.seq.store(pos + kCapacity, std::memory_order_release);
+        drained_.store(++pos, std::memory_order_release);
+        any = true;
+    }
+    if(any) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+    return any;
+}
+
+void Log::drain_loop() {
+    for(;;) {
+        bool stopping = stop_.load(std::memory_order_acquire);
+        if(!drain_some()) {
+            if(stopping) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    uint64_t lost = dropped();
+    if(lost) std::fprintf(stderr, "[LOG] %llu messages dropped (ring full)\n", static_cast<unsigned long long>(lost));
+}
+
+void Log::flush() {
+    uint64_t target = tail_.load(std::memory_order_acquire);
+    while(drained_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,140 @@
+#include "../headers/MoveIntegrator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void MoveIntegrator::add(uint32_t row, Cell start, Cell end, int start_ms, int dur_ms) {
+    if(!in_range(start, end)) {
+        throw std::invalid_argument("MoveIntegrator: move from (" + std::to_string(start.first) + "," +
+                                    std::to_string(start.second) + ") to (" + std::to_string(end.first) + "," +
+                                    std::to_string(end.second) + ") is longer than " +
+                                    std::to_string(kMaxCells) + " cells");
+    }
+    remove(row);
+    if(slot_of_.size() <= row) slot_of_.resize(row + 1, -1);
+    slot_of_[row] = static_cast<int32_t>(rows_.size());
+    rows_.push_back(row);
+
+    int32_t x0 = to_q(start.second), y0 = to_q(start.first);
+    int32_t x1 = to_q(end.second),   y1 = to_q(end.first);
+    start_ms_.push_back(start_ms);
+    dur_ms_.push_back(dur_ms);
+    x0_.push_back(x0);
+    y0_.push_back(y0);
+    x1_.push_back(x1);
+    y1_.push_back(y1);
+    vx_.push_back(velocity(x1 - x0, dur_ms));
+    vy_.push_back(velocity(y1 - y0, dur_ms));
+    x_.push_back(x0);
+    y_.push_back(y0);
+    col_.push_back(start.second);
+    row_.push_back(start.first);
+    flags_.push_back(0);
+}
+
+void MoveIntegrator::remove(uint32_t row) {
+    if(row >= slot_of_.size() || slot_of_[row] < 0) return;
+    size_t slot = static_cast<size_t>(slot_of_[row]);
+    size_t last = rows_.size() - 1;
+    if(slot != last) {
+        // Swap the last move into the freed slot
+        rows_[slot] = rows_[last];
+        start_ms_[slot] = start_ms_[last];
+        dur_ms_[slot] = dur_ms_[last];
+        x0_[slot] = x0_[last];
+        y0_[slot] = y0_[last];
+        x1_[slot] = x1_[last];
+        y1_[slot] = y1_[last];
+        vx_[slot] = vx_[last];
+        vy_[slot] = vy_[last];
+        x_[slot] = x_[last];
+        y_[slot] = y_[last];
+        col_[slot] = col_[last];
+        row_[slot] = row_[last];
+        slot_of_[rows_[slot]] = static_cast<int32_t>(slot);
+    }
+    slot_of_[row] = -1;
+    rows_.pop_back();
+    start_ms_.pop_back();
+    dur_ms_.pop_back();
+    x0_.pop_back();
+    y0_.pop_back();
+    x1_.pop_back();
+    y1_.pop_back();
+    vx_.pop_back();
+    vy_.pop_back();
+    x_.pop_back();
+    y_.pop_back();
+    col_.pop_back();
+    row_.pop_back();
+    flags_.pop_back();
+}
+
+void MoveIntegrator::clear() {
+    for(uint32_t row : rows_) slot_of_[row] = -1;
+    rows_.clear();
+    start_ms_.clear();
+    dur_ms_.clear();
+    x0_.clear();
+    y0_.clear();
+    x1_.clear();
+    y1_.clear();
+    vx_.clear();
+    vy_.clear();
+    x_.clear();
+    y_.clear();
+    col_.clear();
+    row_.clear();
+    flags_.clear();
+}
+
+// ---------------------------------------------------------------------------
+namespace {
+
+// The per-tick pass. The columns are separate allocations; __restrict on the
+// parameters tells the compiler so, which it needs before it will vectorize.
+// No branches: masks and min/max instead of ifs.
+void integrate(size_t n, int32_t now_ms,
+               const int32_t* __restrict start_ms, const int32_t* __restrict dur_ms,
+               const int32_t* __restrict x0, const int32_t* __restrict y0,
+               const int32_t* __restrict x1, const int32_t* __restrict y1,
+               const int32_t* __restrict vx, const int32_t* __restrict vy,
+               int32_t* __restrict xs, int32_t* __restrict ys,
+               int32_t* __restrict cols, int32_t* __restrict rows,
+               int32_t* __restrict flags, int32_t moved_flag, int32_t arrived_flag) {
+    constexpr int kVelBits = MoveIntegrator::kVelBits;
+    constexpr int kFracBits = MoveIntegrator::kFracBits;
+    constexpr int32_t kHalf = MoveIntegrator::kOne / 2;
+    for(size_t i = 0; i < n; ++i) {
+        int32_t d = dur_ms[i];
+        int32_t t = now_ms - start_ms[i];
+        int32_t arrived = -static_cast<int32_t>(t >= d);   // all ones once over
+        t = std::min(std::max(t, 0), d);
+        int32_t x = x0[i] + ((vx[i] * t) >> kVelBits);
+        int32_t y = y0[i] + ((vy[i] * t) >> kVelBits);
+        x = (x1[i] & arrived) | (x & ~arrived);
+        y = (y1[i] & arrived) | (y & ~arrived);
+        int32_t col = (x + kHalf) >> kFracBits;
+        int32_t row = (y + kHalf) >> kFracBits;
+        int32_t moved = (((col ^ cols[i]) | (row ^ rows[i])) != 0) * moved_flag;
+        flags[i] = moved | (arrived & arrived_flag);
+        xs[i] = x;
+        ys[i] = y;
+        cols[i] = col;
+        rows[i] = row;
+    }
+}
+
+} // namespace
+
+void MoveIntegrator::advance(int now_ms, std::vector<Event>& out) {
+    const size_t n = rows_.size();
+    integrate(n, now_ms, start_ms_.data(), dur_ms_.data(), x0_.data(), y0_.data(), x1_.data(), y1_.data(),
+              vx_.data(), vy_.data(), x_.data(), y_.data(), col_.data(), row_.data(), flags_.data(),
+              kMoved, kArrived);
+
+    for(size_t i = 0; i < n; ++i) {
+        if(flags_[i]) out.push_back({rows_[i], {row_[i], col_[i]}, (flags_[i] & kArrived) != 0, x_[i], y_[i]});
+    }
+}
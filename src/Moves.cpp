@@ -3,6 +3,9 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
 
 // ---------------------------------------------------------------------------
 Moves::Moves(const std::string& txt_path, std::pair<int,int> board_dims)
@@ -22,6 +25,70 @@ Moves::Moves(const std::string& txt_path, std::pair<int,int> board_dims)
         if(line.substr(start,1) == "#") continue; // comment
         rel_moves.push_back(parse_line(line));
     }
+    build_tables();
+}
+
+Moves::Moves(std::vector<RelMove> moves, std::pair<int,int> board_dims)
+    : rel_moves(std::move(moves)), W(board_dims.first), H(board_dims.second) {
+    build_tables();
+}
+
+// ---------------------------------------------------------------------------
+// Offsets of the cells strictly between (0,0) and (dr,dc), stepping along the
+// longer axis and rounding the other (empty for one-cell moves).
+void Moves::append_steps(int dr, int dc, std::vector<std::pair<int,int>>& out) {
+    if(std::abs(dr) <= 1 && std::abs(dc) <= 1) return;
+    int steps = std::max(std::abs(dr), std::abs(dc));
+    double step_r = static_cast<double>(dr) / steps;
+    double step_c = static_cast<double>(dc) / steps;
+    for(int i = 1; i < steps; ++i) {
+        out.emplace_back(static_cast<int>(std::round(i * step_r)),
+                         static_cast<int>(std::round(i * step_c)));
+    }
+}
+
+// Precompute the integer ray of every move once, then for every source
+// square the mask of its on-board cells.
+void Moves::build_tables() {
+    size_t n_moves = rel_moves.size();
+    ray_steps.clear();
+    ray_begin.assign(1, 0);
+    for(const auto& mv : rel_moves) {
+        append_steps(mv.dr, mv.dc, ray_steps);
+        ray_begin.push_back(static_cast<uint32_t>(ray_steps.size()));
+    }
+
+    if(W <= 0 || H <= 0) return;
+    offset_to_move.assign(static_cast<size_t>(2 * H - 1) * (2 * W - 1), -1);
+    for(size_t i = 0; i < n_moves; ++i) {
+        const auto& mv = rel_moves[i];
+        if(std::abs(mv.dr) >= H || std::abs(mv.dc) >= W) continue;   // never on the board
+        auto& slot = offset_to_move[(mv.dr + H - 1) * (2 * W - 1) + (mv.dc + W - 1)];
+        if(slot < 0) slot = static_cast<int16_t>(i);   // first entry wins, as in is_dst_cell_valid
+    }
+
+    mask_words = Occupancy::word_count_for(W, H);
+    ray_masks.assign(static_cast<size_t>(W) * H * n_moves * mask_words, 0);
+    for(int r0 = 0; r0 < H; ++r0) {
+        for(int c0 = 0; c0 < W; ++c0) {
+            size_t sq = static_cast<size_t>(r0) * W + c0;
+            for(size_t m = 0; m < n_moves; ++m) {
+                uint64_t* mask = &ray_masks[(sq * n_moves + m) * mask_words];
+                for(uint32_t k = ray_begin[m]; k < ray_begin[m + 1]; ++k) {
+                    int r = r0 + ray_steps[k].first;
+                    int c = c0 + ray_steps[k].second;
+                    if(r < 0 || r >= H || c < 0 || c >= W) continue;
+                    int bit = r * W + c;
+                    mask[bit >> 6] |= uint64_t(1) << (bit & 63);
+                }
+            }
+        }
+    }
+}
+
+int Moves::move_index(int dr, int dc) const {
+    if(std::abs(dr) >= H || std::abs(dc) >= W || offset_to_move.empty()) return -1;
+    return offset_to_move[(dr + H - 1) * (2 * W - 1) + (dc + W - 1)];
 }
 
 // ---------------------------------------------------------------------------
@@ -93,13 +160,68 @@ bool Moves::path_is_clear(const std::pair<int,int>& src_cell,
     int dr = dst_cell.first - src_cell.first;
     int dc = dst_cell.second - src_cell.second;
     if(std::abs(dr) <= 1 && std::abs(dc) <= 1) return true;
-    int steps = std::max(std::abs(dr), std::abs(dc));
-    double step_r = static_cast<double>(dr) / steps;
-    double step_c = static_cast<double>(dc) / steps;
-    for(int i=1; i<steps; ++i) {
-        int r = src_cell.first + static_cast<int>(std::round(i * step_r));
-        int c = src_cell.second + static_cast<int>(std::round(i * step_c));
-        if(cell_with_piece.count({r,c})) return false;
+
+    const std::pair<int,int>* first;
+    const std::pair<int,int>* last;
+    std::vector<std::pair<int,int>> scratch;
+    int m = move_index(dr, dc);
+    if(m >= 0) {
+        first = ray_steps.data() + ray_begin[m];
+        last = ray_steps.data() + ray_begin[m + 1];
+    } else {
+        // Offset not in the table (off-board move): walk it the slow way
+        append_steps(dr, dc, scratch);
+        first = scratch.data();
+        last = first + scratch.size();
+    }
+    for(; first != last; ++first) {
+        if(cell_with_piece.count({src_cell.first + first->first, src_cell.second + first->second})) return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+// ---------------------------------------------------------------------------
+void Moves::check_dims(const Occupancy& occupancy) const {
+    if(occupancy.width() != W || occupancy.height() != H) {
+        throw std::invalid_argument("Occupancy dimensions do not match the Moves board");
+    }
+}
+
+// Tag and path test for rel_moves[move] from square src_index (dst in bounds)
+bool Moves::passes(int src_index, int move, const std::pair<int,int>& dst_cell,
+                   const Occupancy& occupancy) const {
+    int tag = rel_moves[move].tag;
+    if(tag >= 0 && occupancy.test(dst_cell) != (tag == 1)) return false;
+    size_t slot = static_cast<size_t>(src_index) * rel_moves.size() + move;
+    return !occupancy.intersects(&ray_masks[slot * mask_words]);
+}
+
+bool Moves::is_valid(const std::pair<int,int>& src_cell,
+                     const std::pair<int,int>& dst_cell,
+                     const Occupancy& occupancy) const {
+    check_dims(occupancy);
+    if(!occupancy.in_bounds(src_cell) || !occupancy.in_bounds(dst_cell)) return false;
+
+    int m = move_index(dst_cell.first - src_cell.first, dst_cell.second - src_cell.second);
+    if(m < 0) return false;
+    return passes(occupancy.index(src_cell), m, dst_cell, occupancy);
+}
+
+size_t Moves::generate(const std::pair<int,int>& src_cell,
+                       const Occupancy& occupancy,
+                       std::pair<int,int>* out,
+                       size_t capacity) const {
+    check_dims(occupancy);
+    if(!occupancy.in_bounds(src_cell)) return 0;
+
+    int src_index = occupancy.index(src_cell);
+    size_t n = 0;
+    for(int m = 0; m < static_cast<int>(rel_moves.size()) && n < capacity; ++m) {
+        const auto& mv = rel_moves[m];
+        std::pair<int,int> dst{src_cell.first + mv.dr, src_cell.second + mv.dc};
+        if(!occupancy.in_bounds(dst)) continue;
+        if(move_index(mv.dr, mv.dc) != m) continue;   // duplicate offset: first entry decides
+        if(passes(src_index, m, dst, occupancy)) out[n++] = dst;
+    }
+    return n;
+}
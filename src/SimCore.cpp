@@ -0,0 +1,138 @@
+#include "../headers/SimCore.hpp"
+
+#include <algorithm>
+
+void SimCore::resize(size_t rows) {
+    tmpl.resize(rows, nullptr);
+    state_id.resize(rows, -1);
+    kind.resize(rows, PhysicsKind::Idle);
+    physics.resize(rows);
+    graphics.resize(rows);
+}
+
+void SimCore::copy_row(const SimCore& from, uint32_t src, uint32_t dst) {
+    tmpl[dst] = from.tmpl[src];
+    state_id[dst] = from.state_id[src];
+    kind[dst] = from.kind[src];
+    physics.copy_row(from.physics, src, dst);
+    graphics[dst] = from.graphics[src];
+    track_move(dst);
+}
+
+void SimCore::init_row(uint32_t row, const PieceTemplate& t) {
+    tmpl[row] = &t;
+    state_id[row] = t.idle_id;
+    kind[row] = t.state(t.idle_id).physics.kind();
+}
+
+void SimCore::enter(uint32_t row, int next_state, const CompactCommand& cmd) {
+    state_id[row] = next_state;
+    const StateTemplate& st = state(row);
+    kind[row] = st.physics.kind();
+    st.physics.reset(physics, row, cmd);
+    st.graphics->reset(graphics[row], cmd);
+    track_move(row);
+}
+
+// Keep `moves` holding exactly the rows whose physics is Move
+void SimCore::track_move(uint32_t row) {
+    if(kind[row] == PhysicsKind::Move) {
+        moves.add(row, physics.start_cell[row], physics.end_cell[row], physics.start_ms[row], physics.duration_ms[row]);
+    } else {
+        moves.remove(row);
+    }
+}
+
+void SimCore::transition(uint32_t row, const CompactCommand& cmd) {
+    int next = tmpl[row]->next_state(state_id[row], cmd.event);
+    if(next >= 0) enter(row, next, cmd);
+}
+
+// ---------------------------------------------------------------------------
+// One row whose physics is known to be P: the update call is direct (and
+// inlinable); only a row raising an event goes back through the generic
+// transition. Nothing here allocates.
+template <typename P>
+bool SimCore::update_as(uint32_t row, int now_ms) {
+    const P& ph = state(row).physics.template as<P>();
+    Cell cell_before = cell_of(ph, row);
+    int state_before = state_id[row];
+    EventId event = ph.update(physics, row, now_ms);
+    if(event != Events::kNone) {
+        transition(row, CompactCommand::make(now_ms, event));
+        return state_id[row] != state_before || current_cell(row) != cell_before;
+    }
+    // Animation frames are derived from graphics[row].start_ms when drawn, so
+    // nothing else needs advancing here.
+    return cell_of(ph, row) != cell_before;
+}
+
+bool SimCore::update(uint32_t row, int now_ms) {
+    switch(kind[row]) {
+        case PhysicsKind::Move:            return update_as<MovePhysics>(row, now_ms);
+        case PhysicsKind::StaticTemporary: return update_as<StaticTemporaryPhysics>(row, now_ms);
+        case PhysicsKind::Jump:            return update_as<JumpPhysics>(row, now_ms);
+        case PhysicsKind::Rest:            return update_as<RestPhysics>(row, now_ms);
+        case PhysicsKind::Idle:            break;   // never moves or finishes on its own
+    }
+    return false;
+}
+
+template <typename P>
+void SimCore::update_run(const uint32_t* rows, size_t n, int now_ms, uint8_t* changed) {
+    for(size_t i = 0; i < n; ++i) {
+        changed[rows[i]] = update_as<P>(rows[i], now_ms) ? 1 : 0;
+    }
+}
+
+void SimCore::group_by_kind(uint32_t* rows, size_t n) const {
+    std::sort(rows, rows + n, [this](uint32_t a, uint32_t b) {
+        return kind[a] != kind[b] ? kind[a] < kind[b] : a < b;
+    });
+}
+
+void SimCore::update_rows(const uint32_t* rows, size_t n, int now_ms, uint8_t* changed) {
+    size_t i = 0;
+    while(i < n) {
+        // Find the run of rows sharing a kind before any of them transitions
+        PhysicsKind k = kind[rows[i]];
+        size_t end = i + 1;
+        while(end < n && kind[rows[end]] == k) ++end;
+        const uint32_t* run = rows + i;
+        switch(k) {
+            case PhysicsKind::Move:            update_run<MovePhysics>(run, end - i, now_ms, changed); break;
+            case PhysicsKind::StaticTemporary: update_run<StaticTemporaryPhysics>(run, end - i, now_ms, changed); break;
+            case PhysicsKind::Jump:            update_run<JumpPhysics>(run, end - i, now_ms, changed); break;
+            case PhysicsKind::Rest:            update_run<RestPhysics>(run, end - i, now_ms, changed); break;
+            case PhysicsKind::Idle:
+                for(size_t j = i; j < end; ++j) changed[rows[j]] = 0;
+                break;
+        }
+        i = end;
+    }
+}
+
+void SimCore::advance_moves(int now_ms, std::vector<uint32_t>& changed) {
+    move_events_.clear();
+    moves.advance(now_ms, move_events_);
+    // Transitions change `moves`, so only act once the pass is over
+    for(const auto& ev : move_events_) {
+        const MovePhysics& ph = state(ev.row).physics.as<MovePhysics>();
+        physics.curr_pos_m[ev.row] = ph.to_m(ev.x_q, ev.y_q);
+        if(ev.arrived) transition(ev.row, CompactCommand::make(now_ms, Events::kDone));
+        changed.push_back(ev.row);
+    }
+}
+
+SimCore::Cell SimCore::current_cell(uint32_t row) const {
+    return cell_of(state(row).physics.base(), row);
+}
+
+SimCore::Cell SimCore::cell_of(const BasePhysics& ph, uint32_t row) const {
+    auto cell = ph.get_curr_cell(physics, row);
+    // Check for invalid values and use fallback
+    if (cell.first < -1000000 || cell.second < -1000000) {
+        return physics.start_cell[row];
+    }
+    return cell;
+}
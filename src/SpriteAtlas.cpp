@@ -0,0 +1,56 @@
+#include "../headers/SpriteAtlas.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SpriteAtlas SpriteAtlas::pack(const std::vector<ImgPtr>& images, const ImgFactoryPtr& img_factory) {
+    SpriteAtlas out;
+    out.views = images;
+    out.rects.assign(images.size(), Rect{0, 0, 0, 0});
+    if(images.empty() || !img_factory) return out;
+
+    // Channel count of the canvas follows the sprites (BGRA for the pieces)
+    int channels = 0;
+    long long area = 0;
+    int widest = 0;
+    std::vector<size_t> order;
+    for(size_t i = 0; i < images.size(); ++i) {
+        if(!images[i]) continue;
+        auto size = images[i]->size();
+        if(size.first <= 0 || size.second <= 0) continue;
+        channels = std::max(channels, images[i]->channels());
+        area += static_cast<long long>(size.first) * size.second;
+        widest = std::max(widest, size.first);
+        order.push_back(i);
+    }
+    if(order.empty()) return out;
+
+    // Shelf packing, tallest first, into a roughly square canvas
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return images[a]->size().second > images[b]->size().second;
+    });
+    int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area)) / widest)));
+    int canvas_w = columns * widest;
+    int x = 0, y = 0, shelf_h = 0;
+    for(size_t i : order) {
+        auto size = images[i]->size();
+        if(x + size.first > canvas_w) {
+            x = 0;
+            y += shelf_h;
+            shelf_h = 0;
+        }
+        out.rects[i] = {x, y, size.first, size.second};
+        x += size.first;
+        shelf_h = std::max(shelf_h, size.second);
+    }
+    int canvas_h = y + shelf_h;
+
+    out.atlas = img_factory->create_canvas(canvas_w, canvas_h, channels > 0 ? channels : 3);
+    if(!out.atlas) return out;
+    for(size_t i : order) {
+        const Rect& r = out.rects[i];
+        images[i]->draw_on(*out.atlas, r.x, r.y);
+        if(auto view = out.atlas->sub_image(r.x, r.y, r.w, r.h)) out.views[i] = view;
+    }
+    return out;
+}
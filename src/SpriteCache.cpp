@@ -0,0 +1,232 @@
+#include "../headers/SpriteCache.hpp"
+#include "../headers/SpriteAtlas.hpp"
+#include "../headers/Log.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <tuple>
+
+namespace fs = std::filesystem;
+
+SpriteCache& SpriteCache::instance() {
+    static SpriteCache cache;
+    return cache;
+}
+
+std::string SpriteCache::canonical_path(const std::string& path) {
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(fs::path(path), ec);
+    return ec ? path : canonical.string();
+}
+
+std::type_index SpriteCache::factory_type(const ImgFactoryPtr& img_factory) {
+    return img_factory ? std::type_index(typeid(*img_factory)) : std::type_index(typeid(void));
+}
+
+SpriteCache::Key SpriteCache::make_key(const std::string& path, std::pair<int,int> size,
+                                       const ImgFactoryPtr& img_factory) {
+    return {canonical_path(path), size.first, size.second, factory_type(img_factory)};
+}
+
+// ---------------------------------------------------------------------------
+ImgPtr SpriteCache::load(const std::string& path,
+                         std::pair<int,int> size,
+                         const ImgFactoryPtr& img_factory) {
+    Key key = make_key(path, size, img_factory);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = images_.find(key);
+        if(it != images_.end()) return it->second;
+    }
+    if(!img_factory) return nullptr;
+
+    // Decode outside the lock; if another thread won the race keep its copy.
+    ImgPtr img = img_factory->load(path, size);
+    if(!img) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = images_.emplace(std::move(key), img);
+    if(inserted.second) atlas_stale_ = true;
+    return inserted.first->second;
+}
+
+std::vector<std::string> SpriteCache::list_frames(const std::string& sprites_folder) {
+    std::vector<fs::path> pngs;
+    fs::path root(sprites_folder);
+    if(!sprites_folder.empty() && fs::exists(root) && fs::is_directory(root)) {
+        for(const auto& entry : fs::directory_iterator(root)) {
+            if(entry.is_regular_file() && entry.path().extension() == ".png") {
+                pngs.push_back(entry.path());
+            }
+        }
+        // Sort files numerically (1.png, 2.png, 3.png, etc.)
+        std::sort(pngs.begin(), pngs.end(), [](const fs::path& a, const fs::path& b) {
+            return std::stoi(a.stem().string()) < std::stoi(b.stem().string());
+        });
+    }
+    std::vector<std::string> out;
+    out.reserve(pngs.size());
+    for(const auto& p : pngs) out.push_back(p.string());
+    return out;
+}
+
+FrameSetPtr SpriteCache::load_frames(const std::string& sprites_folder,
+                                     std::pair<int,int> size,
+                                     const ImgFactoryPtr& img_factory) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = frame_sets_.find(make_key(sprites_folder, size, img_factory));
+        if(it != frame_sets_.end()) return it->second;
+    }
+    return load_frames(sprites_folder, list_frames(sprites_folder), size, img_factory);
+}
+
+FrameSetPtr SpriteCache::load_frames(const std::string& sprites_folder,
+                                     const std::vector<std::string>& frame_paths,
+                                     std::pair<int,int> size,
+                                     const ImgFactoryPtr& img_factory) {
+    Key key = make_key(sprites_folder, size, img_factory);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = frame_sets_.find(key);
+        if(it != frame_sets_.end()) return it->second;
+    }
+
+    auto frames = std::make_shared<FrameSet>();
+    if(!frame_paths.empty()) {
+        KFC_LOG_DEBUG("Loading frames in order: %s", sprites_folder.c_str());
+    }
+    for(size_t i = 0; i < frame_paths.size(); ++i) {
+        KFC_LOG_TRACE("Frame %zu: %s", i, fs::path(frame_paths[i]).filename().string().c_str());
+        auto img_ptr = load(frame_paths[i], size, img_factory);
+        if(img_ptr) {
+            frames->push_back(img_ptr);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frame_sets_.emplace(std::move(key), std::move(frames)).first->second;
+}
+
+// ---------------------------------------------------------------------------
+FrameSetPtr SpriteCache::acquire_lru(const std::string& folder,
+                                     const std::vector<std::string>& frame_paths,
+                                     std::pair<int,int> size,
+                                     const ImgFactoryPtr& img_factory) {
+    Key key{folder, size.first, size.second, factory_type(img_factory)};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = lru_index_.find(key);
+        if(it != lru_index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Decode outside the lock; these frames never enter the permanent maps.
+    auto frames = std::make_shared<FrameSet>();
+    KFC_LOG_DEBUG("Decoding frames on demand: %s", folder.c_str());
+    for(const auto& path : frame_paths) {
+        auto img_ptr = img_factory ? img_factory->load(path, size) : nullptr;
+        if(img_ptr) frames->push_back(img_ptr);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lru_index_.find(key);
+    if(it != lru_index_.end()) return it->second->second;   // lost the race
+
+    lru_.emplace_front(key, std::move(frames));
+    lru_index_[key] = lru_.begin();
+    while(lru_.size() > lru_capacity_) {
+        lru_index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return lru_.front().second;
+}
+
+void SpriteCache::set_lru_capacity(size_t frame_sets) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_capacity_ = std::max<size_t>(frame_sets, 1);
+    while(lru_.size() > lru_capacity_) {
+        lru_index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+size_t SpriteCache::lru_capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_capacity_;
+}
+
+size_t SpriteCache::lru_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+// ---------------------------------------------------------------------------
+size_t SpriteCache::build_atlas(const ImgFactoryPtr& img_factory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Already packed: repacking would copy the views into yet another atlas
+    // while Graphics built earlier keep the current one alive.
+    if(!atlas_stale_) return 0;
+
+    // Only images this factory's type decoded; deterministic layout: pack in
+    // path order
+    const std::type_index factory = factory_type(img_factory);
+    std::vector<const Key*> keys;
+    keys.reserve(images_.size());
+    for(const auto& entry : images_) {
+        if(entry.first.factory == factory) keys.push_back(&entry.first);
+    }
+    std::sort(keys.begin(), keys.end(), [](const Key* a, const Key* b) {
+        return std::tie(a->path, a->w, a->h) < std::tie(b->path, b->w, b->h);
+    });
+
+    std::vector<ImgPtr> originals;
+    originals.reserve(keys.size());
+    for(const Key* key : keys) originals.push_back(images_[*key]);
+
+    SpriteAtlas packed = SpriteAtlas::pack(originals, img_factory);
+    if(!packed.atlas) return 0;
+
+    std::unordered_map<const Img*, ImgPtr> remap;
+    for(size_t i = 0; i < keys.size(); ++i) {
+        remap[originals[i].get()] = packed.views[i];
+        images_[*keys[i]] = packed.views[i];
+    }
+    for(auto& entry : frame_sets_) {
+        auto frames = std::make_shared<FrameSet>(*entry.second);
+        for(auto& img : *frames) {
+            auto it = remap.find(img.get());
+            if(it != remap.end()) img = it->second;
+        }
+        entry.second = std::move(frames);
+    }
+    atlas_ = packed.atlas;
+    atlas_stale_ = false;
+
+    auto size = atlas_->size();
+    KFC_LOG_INFO("Packed %zu sprites into a %dx%d atlas", keys.size(), size.first, size.second);
+    return keys.size();
+}
+
+ImgPtr SpriteCache::atlas() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return atlas_;
+}
+
+// ---------------------------------------------------------------------------
+void SpriteCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    images_.clear();
+    frame_sets_.clear();
+    lru_.clear();
+    lru_index_.clear();
+    atlas_.reset();
+    atlas_stale_ = false;
+}
+
+size_t SpriteCache::image_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return images_.size();
+}
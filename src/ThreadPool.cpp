@@ -0,0 +1,109 @@
+#include "../headers/ThreadPool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+// Which pool (and which worker of it) the current thread belongs to
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_worker = 0;
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for(unsigned i = 0; i < threads; ++i) queues.push_back(std::make_unique<Queue>());
+    for(unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& t : workers) t.join();
+}
+
+size_t ThreadPool::current_worker() const {
+    return tls_pool == this ? tls_worker : queues.size();
+}
+
+// ---------------------------------------------------------------------------
+void ThreadPool::submit(Task task) {
+    size_t self = current_worker();
+    size_t target = self < queues.size() ? self : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Counted under sleep_mutex so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        pending.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::run_one(size_t self) {
+    Task task;
+    // Own deque first (newest task, still warm in cache) ...
+    if(self < queues.size()) {
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        if(!queues[self]->tasks.empty()) {
+            task = std::move(queues[self]->tasks.back());
+            queues[self]->tasks.pop_back();
+        }
+    }
+    // ... then steal the oldest task of the others
+    for(size_t k = 1; !task && k <= queues.size(); ++k) {
+        size_t victim = (self + k) % queues.size();
+        std::lock_guard<std::mutex> lock(queues[victim]->mutex);
+        if(!queues[victim]->tasks.empty()) {
+            task = std::move(queues[victim]->tasks.front());
+            queues[victim]->tasks.pop_front();
+        }
+    }
+    if(!task) return false;
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t self) {
+    tls_pool = this;
+    tls_worker = self;
+    for(;;) {
+        if(run_one(self)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this]() { return stopping || pending.load(std::memory_order_acquire) > 0; });
+        if(stopping && pending.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+// ---------------------------------------------------------------------------
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+    if(n == 0) return;
+    std::atomic<size_t> remaining{n};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    for(size_t i = 0; i < n; ++i) {
+        submit([&, i]() {
+            try {
+                fn(i);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!error) error = std::current_exception();
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        });
+    }
+
+    size_t self = current_worker();
+    while(remaining.load(std::memory_order_acquire) > 0) {
+        if(!run_one(self)) std::this_thread::yield();
+    }
+    if(error) std::rethrow_exception(error);
+}
@@ -0,0 +1,75 @@
+#include "../headers/UiPump.hpp"
+#include "../headers/Log.hpp"
+#include "img/OpenCvImg.hpp"
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+UiPump::UiPump(KeyHandler on_key_, TimeSource now_ms_)
+    : on_key(std::move(on_key_)), now_ms(std::move(now_ms_)) {}
+
+UiPump::~UiPump() {
+    stop();
+}
+
+void UiPump::start() {
+    if(running_.exchange(true)) return;
+    KFC_LOG_INFO("[UI] Starting UI thread...");
+    worker_ = std::thread([this]() { loop(); });
+}
+
+void UiPump::stop() {
+    running_ = false;
+    if(worker_.joinable()) worker_.join();
+}
+
+void UiPump::present(ImgPtr frame, int input_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_frame = std::move(frame);
+    // A replaced frame's input is still waiting to be seen: keep the oldest
+    if(input_ms >= 0 && (pending_input_ms < 0 || input_ms < pending_input_ms)) {
+        pending_input_ms = input_ms;
+    }
+}
+
+UiPump::LatencyStats UiPump::latency() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LatencyStats stats;
+    stats.samples = samples;
+    stats.mean_ms = samples ? static_cast<double>(total_latency_ms) / samples : 0.0;
+    stats.max_ms = max_latency_ms;
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+void UiPump::loop() {
+    while(running_) {
+        ImgPtr frame;
+        int input_ms = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frame = std::move(pending_frame);
+            pending_frame.reset();
+            if(frame) {
+                input_ms = pending_input_ms;
+                pending_input_ms = -1;
+            }
+        }
+
+        if(frame) frame->show();
+
+        // Pumps window events and paints the frame; returns early on a key
+        int key = cv::waitKey(1);
+        int now = now_ms();
+
+        if(frame && input_ms >= 0) {
+            int latency = std::max(0, now - input_ms);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++samples;
+            total_latency_ms += latency;
+            max_latency_ms = std::max(max_latency_ms, latency);
+        }
+        if(key >= 0) on_key(key & 0xFF, now);
+    }
+    OpenCvImg::close_all_windows();
+}
@@ -16,10 +16,19 @@ public:
     // Default no-op implementations allow direct instantiation for tests
     virtual void read(const std::string& /*path*/, const std::pair<int,int>& /*size*/ = {0,0}) {}
     virtual std::pair<int,int> size() const = 0;
+    virtual int channels() const { return 0; }   // 0 when unknown / no pixels
     virtual void draw_on(Img& /*dst*/, int /*x*/, int /*y*/) {}
     virtual void put_text(const std::string& /*txt*/, int /*x*/, int /*y*/, double /*font_size*/) {}
     virtual void show() const {}
     virtual ImgPtr clone() const = 0;
 
+    // View of a sub-rectangle sharing this image's pixels (no copy).
+    // Returns nullptr for images that cannot be viewed.
+    virtual ImgPtr sub_image(int /*x*/, int /*y*/, int /*width*/, int /*height*/) const { return nullptr; }
+
+    // Tightly packed copy of the pixels (rows of width*channels bytes).
+    // Returns false for images without pixel storage.
+    virtual bool copy_pixels(std::vector<uint8_t>& /*out*/, int& /*channels*/) const { return false; }
+
     virtual void draw_rect(int x, int y, int width, int height, const std::vector<uint8_t> & color) = 0;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <cstdint>
 #include "Img.hpp"
 
 class ImgFactory {
@@ -13,5 +14,16 @@ public:
                                       const std::pair<int,int>& size = {0,0}) = 0;
 
     virtual ImgPtr create_blank(int width, int height) const = 0;
+
+    // Blank image with an explicit channel count (e.g. 4 for BGRA sprites).
+    virtual ImgPtr create_canvas(int width, int height, int /*channels*/) const {
+        return create_blank(width, height);
+    }
+
+    // Image viewing external, already decoded pixels (no copy). `owner` keeps
+    // the memory alive for as long as the image exists.
+    virtual ImgPtr from_pixels(int width, int height, int channels,
+                               const uint8_t* data,
+                               std::shared_ptr<const void> owner) const = 0;
 };
 typedef std::shared_ptr<ImgFactory> ImgFactoryPtr;
\ No newline at end of file
@@ -15,6 +15,9 @@ public:
     void put_text(const std::string&, int, int, double) override {}
     void show() const override {}
     ImgPtr clone() const override { return std::make_shared<MockImg>(); }
+    ImgPtr sub_image(int, int, int width, int height) const override {
+        return std::make_shared<MockImg>(std::pair<int,int>(width, height));
+    }
     void draw_rect(int x, int y, int width, int height, const std::vector<uint8_t>& color) override {};
 
 };
@@ -29,4 +32,10 @@ public:
     ImgPtr create_blank(int /*width*/, int /*height*/) const override {
         return std::make_shared<MockImg>();
     }
+
+    ImgPtr from_pixels(int width, int height, int /*channels*/,
+                       const uint8_t* /*data*/,
+                       std::shared_ptr<const void> /*owner*/) const override {
+        return std::make_shared<MockImg>(std::pair<int,int>(width, height));
+    }
 }; 
\ No newline at end of file
@@ -5,10 +5,12 @@
 #include <vector>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 struct OpenCvImg::Impl {
 	cv::Mat mat;
+	std::shared_ptr<const void> owner; // backing memory of wrapped pixels
 };
 
 OpenCvImg::OpenCvImg() : impl(std::make_unique<Impl>()) {}
@@ -28,12 +30,43 @@ void OpenCvImg::read(const std::string& path, const std::pair<int, int>& size) {
 	}
 }
 
+void OpenCvImg::wrap_pixels(int w, int h, int channels, const uint8_t* data,
+                            std::shared_ptr<const void> owner) {
+	// Sprites are only ever read from, so viewing the mapping is safe
+	impl->mat = cv::Mat(h, w, CV_8UC(channels), const_cast<uint8_t*>(data));
+	impl->owner = std::move(owner);
+}
+
+bool OpenCvImg::copy_pixels(std::vector<uint8_t>& out, int& channels) const {
+	if (impl->mat.empty()) return false;
+	channels = impl->mat.channels();
+	size_t row_bytes = static_cast<size_t>(impl->mat.cols) * channels;
+	out.resize(row_bytes * impl->mat.rows);
+	for (int r = 0; r < impl->mat.rows; ++r) {
+		std::memcpy(out.data() + r * row_bytes, impl->mat.ptr(r), row_bytes);
+	}
+	return true;
+}
+
 std::pair<int,int> OpenCvImg::size() const {
 	return {impl->mat.cols, impl->mat.rows};
 }
 
-void OpenCvImg::create_blank(int w, int h) {
-	impl->mat = cv::Mat(h, w, CV_8UC3, cv::Scalar(0, 0, 0));
+int OpenCvImg::channels() const {
+	return impl->mat.empty() ? 0 : impl->mat.channels();
+}
+
+void OpenCvImg::create_blank(int w, int h, int channels) {
+	impl->mat = cv::Mat(h, w, CV_8UC(channels), cv::Scalar(0, 0, 0, 0));
+}
+
+ImgPtr OpenCvImg::sub_image(int x, int y, int w, int h) const {
+	if (impl->mat.empty()) return nullptr;
+	if (x < 0 || y < 0 || x + w > impl->mat.cols || y + h > impl->mat.rows) return nullptr;
+	auto res = std::make_shared<OpenCvImg>();
+	res->impl->mat = impl->mat(cv::Rect(x, y, w, h));   // ROI header, shares the buffer
+	res->impl->owner = impl->owner;
+	return res;
 }
 
 void OpenCvImg::draw_on(Img& dst, int x, int y) {
@@ -84,8 +117,7 @@ void OpenCvImg::put_text(const std::string& txt, int x, int y, double font_size)
 void OpenCvImg::show() const {
 	if (impl->mat.empty()) return;
 	cv::namedWindow("KungFu Chess", cv::WINDOW_AUTOSIZE);
-	cv::imshow("KungFu Chess", impl->mat);
-	cv::waitKey(1); // Just refresh the window
+	cv::imshow("KungFu Chess", impl->mat); // painted by the caller's cv::waitKey (see UiPump)
 }
 
 void OpenCvImg::draw_rect(int x, int y, int width, int height, const std::vector<uint8_t> & color) {
@@ -14,13 +14,19 @@ public:
     void read(const std::string& path,
               const std::pair<int,int>& size = {0,0}) override;
     std::pair<int,int> size() const override;
+    int channels() const override;
     
     void draw_on(Img& dst, int x, int y) override;
     void put_text(const std::string& txt, int x, int y, double font_size) override;
     void show() const override;
     ImgPtr clone() const override;
+    bool copy_pixels(std::vector<uint8_t>& out, int& channels) const override;
+    ImgPtr sub_image(int x, int y, int width, int height) const override;
 
-    void create_blank(int width, int height);
+    void create_blank(int width, int height, int channels = 3);
+    // View over external pixels; the owner is kept alive with the image.
+    void wrap_pixels(int width, int height, int channels, const uint8_t* data,
+                     std::shared_ptr<const void> owner);
 
     void draw_rect(int x, int y, int width, int height, const std::vector<uint8_t> & color) override;
     
@@ -39,10 +45,24 @@ public:
         return img;
     }
 
+    ImgPtr create_canvas(int width, int height, int channels) const override {
+        auto img = std::make_shared<OpenCvImg>();
+        img->create_blank(width, height, channels);
+        return img;
+    }
+
     ImgPtr load(const std::string& path,
                 const std::pair<int,int>& size = {0,0}) override {
         auto img = std::make_shared<OpenCvImg>();
         img->read(path, size);
         return img;
     }
+
+    ImgPtr from_pixels(int width, int height, int channels,
+                       const uint8_t* data,
+                       std::shared_ptr<const void> owner) const override {
+        auto img = std::make_shared<OpenCvImg>();
+        img->wrap_pixels(width, height, channels, data, std::move(owner));
+        return img;
+    }
 };
\ No newline at end of file
@@ -2,20 +2,39 @@
 #include "Game.hpp"
 #include "img/OpenCvImg.hpp"
 #include <memory>
+#include <string>
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        // --headless N: simulate N ticks on a virtual clock, no window
+        int headless_ticks = -1;
+        for(int i = 1; i + 1 < argc; ++i) {
+            if(std::string(argv[i]) == "--headless") headless_ticks = std::stoi(argv[i + 1]);
+        }
+
         std::cout << "=== KFC Merged - Kung Fu Chess Game ===" << std::endl;
         std::cout << "Initializing OpenCV image factory..." << std::endl;
         
         auto img_factory = std::make_shared<OpenCvImgFactory>();
         std::string pieces_root = "pieces/";
         
-        std::cout << "Creating game from pieces directory: " << pieces_root << std::endl;
-        auto game = create_game(pieces_root, img_factory);
+        // Prefer the packed bundle written by kfc_pack, unless the pieces/
+        // tree has changed since it was packed
+        std::string bundle_path = pieces_root + "assets.kfcb";
+        bool use_bundle = AssetBundle::is_up_to_date(bundle_path, pieces_root);
+
+        std::cout << "Creating game from " << (use_bundle ? bundle_path : "pieces directory: " + pieces_root) << std::endl;
+        auto game = use_bundle ? create_game_from_bundle(bundle_path, img_factory)
+                               : create_game(pieces_root, img_factory);
         
-        std::cout << "Starting game with graphics enabled..." << std::endl;
-        game.run(-1, true); // Run for 5 iterations with graphics
+        if(headless_ticks >= 0) {
+            std::cout << "Simulating " << headless_ticks << " ticks headless..." << std::endl;
+            game.set_clock(std::make_shared<VirtualClock>());
+            game.run(headless_ticks, false);
+        } else {
+            std::cout << "Starting game with graphics enabled..." << std::endl;
+            game.run(-1, true);
+        }
         
         std::cout << "Game completed successfully!" << std::endl;
         
@@ -0,0 +1,110 @@
+#include "Test.hpp"
+
+#include "../headers/Game.hpp"
+#include "../headers/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Global operator new replaced for the whole test binary; it only counts
+// while g_counting is set, so the other cases are unaffected.
+// ---------------------------------------------------------------------------
+namespace {
+std::atomic<bool> g_counting{false};
+std::atomic<long> g_allocations{0};
+
+void* counted_alloc(size_t n) {
+    if(g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(n ? n : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void* counted_aligned_alloc(size_t n, std::align_val_t align) {
+    if(g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t a = static_cast<size_t>(align);
+    size_t bytes = ((n ? n : 1) + a - 1) / a * a;
+#ifdef _WIN32
+    void* p = _aligned_malloc(bytes, a);
+#else
+    void* p = std::aligned_alloc(a, bytes);
+#endif
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void aligned_free(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+} // namespace
+
+void* operator new(size_t n) { return counted_alloc(n); }
+void* operator new[](size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+void* operator new(size_t n, std::align_val_t a) { return counted_aligned_alloc(n, a); }
+void* operator new[](size_t n, std::align_val_t a) { return counted_aligned_alloc(n, a); }
+void operator delete(void* p, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { aligned_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { aligned_free(p); }
+
+// ---------------------------------------------------------------------------
+TEST_CASE("steady-state ticks do not allocate") {
+    Log::instance().set_level(LogLevel::Warn);
+    constexpr int kCells = 32;
+    auto img_factory = std::make_shared<MockImgFactory>();
+    Board board(80, 80, kCells, kCells, img_factory->create_blank(kCells * 80, kCells * 80));
+    GraphicsFactory gfx_factory(img_factory);
+    PieceFactory piece_factory(board, kfc_test::pieces_root(), gfx_factory);
+
+    // A full row of queens every fourth row
+    std::vector<PiecePtr> pieces;
+    for(int r = 0; r < kCells; r += 4) {
+        for(int c = 0; c < kCells; ++c) pieces.push_back(piece_factory.create_piece("QW", {r, c}));
+    }
+    Game game(pieces, board);
+    game.set_clock(std::make_shared<VirtualClock>());
+    game.begin();
+
+    // Every piece moves two rows down, or back up, then rests and idles
+    int moved = 0;
+    auto cycle = [&](int round) {
+        for(const auto& piece : pieces) {
+            auto from = piece->current_cell();
+            std::pair<int,int> to{from.first + (round % 2 ? -2 : 2), from.second};
+            game.enqueue_command(CompactCommand::make(game.sim_time_ms(), Events::kMove, 1, game.handle_of(piece->id))
+                                     .add_cell(from).add_cell(to));
+        }
+        game.advance(3000);
+        for(const auto& piece : pieces) moved += piece->current_cell().first % 4 != 0;
+    };
+
+    // Warm up: grow every buffer to its working size
+    for(int round = 0; round < 4; ++round) cycle(round);
+
+    g_allocations = 0;
+    g_counting = true;
+    for(int round = 4; round < 8; ++round) cycle(round);
+    g_counting = false;
+
+    CHECK(g_allocations.load() == 0);
+    // Half the rounds leave every piece off its home row
+    CHECK(moved == 4 * static_cast<int>(pieces.size()));
+}
@@ -0,0 +1,44 @@
+#include "Test.hpp"
+
+#include "../headers/Game.hpp"
+#include "../headers/Log.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Cell of a queen 100 ticks after it was sent from (0,0) to (7,0), 10.5 s
+// into the game, with the given command timestamp
+std::pair<int,int> cell_after_move(int stamp_offset_ms) {
+    auto img_factory = std::make_shared<MockImgFactory>();
+    Board board(80, 80, 8, 8, img_factory->create_blank(640, 640));
+    GraphicsFactory gfx_factory(img_factory);
+    PieceFactory piece_factory(board, kfc_test::pieces_root(), gfx_factory);
+
+    auto queen = piece_factory.create_piece("QW", {0, 0});
+    Game game({queen}, board);
+    game.set_clock(std::make_shared<VirtualClock>());
+    game.begin();
+    game.advance(10500 / 5);
+
+    game.enqueue_command(CompactCommand::make(game.sim_time_ms() + stamp_offset_ms, Events::kMove, 1,
+                                              game.handle_of(queen->id))
+                             .add_cell({0, 0}).add_cell({7, 0}));
+    game.advance(100);
+    return queen->current_cell();
+}
+
+} // namespace
+
+TEST_CASE("a command's timestamp does not change when it takes effect") {
+    Log::instance().set_level(LogLevel::Warn);
+    auto honest = cell_after_move(0);
+    CHECK(honest != std::make_pair(0, 0));
+    // A stamp in the past must not skip the piece ahead, nor one in the
+    // future freeze it
+    CHECK(cell_after_move(-10500) == honest);
+    CHECK(cell_after_move(60000) == honest);
+}
@@ -0,0 +1,83 @@
+#include "Test.hpp"
+
+#include "../headers/Game.hpp"
+#include "../headers/Log.hpp"
+#include "../headers/ThreadPool.hpp"
+#include "../src/img/MockImg.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr int kCells = 32;
+
+uint64_t mix(uint64_t h, uint64_t v) {
+    return (h ^ v) * 0x100000001b3ull;
+}
+
+// Hash of every live piece's (slot, cell, state) after each tick
+std::vector<uint64_t> run_scenario(ThreadPool* pool) {
+    auto img_factory = std::make_shared<MockImgFactory>();
+    Board board(80, 80, kCells, kCells, img_factory->create_blank(kCells * 80, kCells * 80));
+    GraphicsFactory gfx_factory(img_factory);
+    PieceFactory piece_factory(board, kfc_test::pieces_root(), gfx_factory);
+
+    // Alternating white / black rows, a free row between them
+    std::vector<PiecePtr> pieces;
+    for(int r = 0; r < kCells; r += 2) {
+        for(int c = 0; c < kCells; ++c) pieces.push_back(piece_factory.create_piece((r / 2) % 2 ? "QB" : "QW", {r, c}));
+    }
+    Game game(pieces, board);
+    game.set_clock(std::make_shared<VirtualClock>());
+    if(pool) game.set_thread_pool(pool);
+    game.begin();
+
+    std::vector<uint64_t> hashes;
+    for(int round = 0; round < 6; ++round) {
+        // One step down, left or right of it: white and black pieces end up
+        // on the same cells, so the rounds also capture.
+        for(size_t i = 0; i < pieces.size(); ++i) {
+            PieceHandle h = game.handle_of(pieces[i]->id);
+            if(!game.pieces.contains(h)) continue;
+            auto from = pieces[i]->current_cell();
+            std::pair<int,int> to{from.first + (round % 2 ? -1 : 1), from.second + static_cast<int>((i + round) % 3) - 1};
+            if(to.first < 0 || to.first >= kCells || to.second < 0 || to.second >= kCells) continue;
+            int player = (i / kCells) % 2 ? 2 : 1;   // the black rows are player 2's
+            game.enqueue_command(CompactCommand::make(game.sim_time_ms(), Events::kMove, player, h).add_cell(from).add_cell(to));
+        }
+        for(int tick = 0; tick < 800; ++tick) {
+            game.advance(1);
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for(auto it = game.pieces.begin(); it != game.pieces.end(); ++it) {
+                auto cell = (*it)->current_cell();
+                hash = mix(hash, it.handle().index());
+                hash = mix(hash, static_cast<uint64_t>(cell.first * kCells + cell.second));
+                hash = mix(hash, static_cast<uint64_t>((*it)->state_id()));
+            }
+            hashes.push_back(hash);
+        }
+    }
+    hashes.push_back(game.pieces.size());
+    return hashes;
+}
+
+} // namespace
+
+TEST_CASE("parallel tick updates match the single-threaded run") {
+    Log::instance().set_level(LogLevel::Warn);
+    std::vector<uint64_t> serial = run_scenario(nullptr);
+    ThreadPool pool(4);
+    std::vector<uint64_t> parallel = run_scenario(&pool);
+
+    REQUIRE(serial.size() == parallel.size());
+    size_t first_diff = serial.size();
+    for(size_t i = 0; i < serial.size() && first_diff == serial.size(); ++i) {
+        if(serial[i] != parallel[i]) first_diff = i;
+    }
+    CHECK(first_diff == serial.size());
+    // The scenario must actually move and capture pieces
+    CHECK(serial.front() != serial[serial.size() - 2]);
+    CHECK(serial.back() < static_cast<uint64_t>(kCells / 2 * kCells));
+}
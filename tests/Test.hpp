@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Minimal self-registering test cases for kungfu_chess_tests, so the tests
+// need nothing outside this repository. TEST_CASE registers a case, CHECK
+// records a failure and carries on, REQUIRE abandons the case.
+// ---------------------------------------------------------------------------
+namespace kfc_test {
+
+struct Case {
+    const char* name;
+    void (*fn)();
+};
+
+std::vector<Case>& registry();
+
+struct Register {
+    Register(const char* name, void (*fn)()) { registry().push_back({name, fn}); }
+};
+
+// Thrown by REQUIRE to abandon the current case
+struct Abort {};
+
+void fail(const char* file, int line, const char* expr);
+
+// Directory holding the piece definitions (pieces/), with trailing slash
+std::string pieces_root();
+
+} // namespace kfc_test
+
+#define KFC_TEST_CAT2(a, b) a##b
+#define KFC_TEST_CAT(a, b) KFC_TEST_CAT2(a, b)
+#define KFC_TEST_CASE_IMPL(fn, name)                                  \
+    static void fn();                                                 \
+    static kfc_test::Register KFC_TEST_CAT(fn, _reg)(name, &fn);      \
+    static void fn()
+#define TEST_CASE(name) KFC_TEST_CASE_IMPL(KFC_TEST_CAT(kfc_test_case_, __LINE__), name)
+
+#define CHECK(expr) ((expr) ? (void)0 : kfc_test::fail(__FILE__, __LINE__, #expr))
+#define REQUIRE(expr) ((expr) ? (void)0 : (kfc_test::fail(__FILE__, __LINE__, #expr), throw kfc_test::Abort{}))
@@ -0,0 +1,45 @@
+#include "Test.hpp"
+
+#include <cstdio>
+#include <exception>
+
+namespace {
+int g_failures = 0;
+}
+
+std::vector<kfc_test::Case>& kfc_test::registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void kfc_test::fail(const char* file, int line, const char* expr) {
+    ++g_failures;
+    std::printf("%s:%d: CHECK failed: %s\n", file, line, expr);
+}
+
+std::string kfc_test::pieces_root() {
+#ifdef KFC_TEST_PIECES_DIR
+    return KFC_TEST_PIECES_DIR;
+#else
+    return "pieces/";
+#endif
+}
+
+int main() {
+    int failed_cases = 0;
+    for(const auto& c : kfc_test::registry()) {
+        int before = g_failures;
+        try {
+            c.fn();
+        } catch(const kfc_test::Abort&) {
+        } catch(const std::exception& e) {
+            ++g_failures;
+            std::printf("%s: unexpected exception: %s\n", c.name, e.what());
+        }
+        bool ok = g_failures == before;
+        if(!ok) ++failed_cases;
+        std::printf("[%s] %s\n", ok ? "  OK  " : "FAILED", c.name);
+    }
+    std::printf("%zu test cases, %d failed\n", kfc_test::registry().size(), failed_cases);
+    return failed_cases == 0 ? 0 : 1;
+}
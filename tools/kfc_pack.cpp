@@ -0,0 +1,27 @@
+// kfc_pack – offline packer for AssetBundle files.
+//
+//   kfc_pack [pieces_root] [out_file] [cell_px] [board_cells]
+//
+// Defaults match create_game: pieces/ -> pieces/assets.kfcb, 80 px cells on
+// an 8x8 board.
+#include <iostream>
+#include <string>
+#include "../headers/AssetBundle.hpp"
+#include "img/OpenCvImg.hpp"
+
+int main(int argc, char** argv) {
+    std::string pieces_root = argc > 1 ? argv[1] : "pieces/";
+    std::string out_path    = argc > 2 ? argv[2] : pieces_root + "/assets.kfcb";
+    int cell_px             = argc > 3 ? std::stoi(argv[3]) : 80;
+    int board_cells         = argc > 4 ? std::stoi(argv[4]) : 8;
+
+    try {
+        auto img_factory = std::make_shared<OpenCvImgFactory>();
+        AssetBundle::pack(pieces_root, out_path, img_factory,
+                          {cell_px, cell_px}, {board_cells, board_cells});
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}